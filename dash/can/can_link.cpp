@@ -0,0 +1,109 @@
+#include <can/can_link.hpp>
+#include <platform/platform.hpp>
+#include <perf/startup_profiler.hpp>
+#include <perf/trace.hpp>
+#include <okay/core/okay.hpp>
+
+#include <algorithm>
+
+void CANLink::tickOnThread(std::function<void()> tick, std::chrono::microseconds period) {
+    _tick = std::move(tick);
+    _period = period;
+}
+
+void CANLink::start() {
+    if (_thread.joinable() || isUp()) {
+        return;
+    }
+
+    _stopping = false;
+    if (!_thread.start(dash::platform::RealtimeRole::CAN, [this] { run(); })) {
+        okay::Engine.logger.error("Unable to start the CAN link thread");
+    }
+}
+
+void CANLink::stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _wake.notify_all();
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void CANLink::run() {
+    dash::perf::trace::setThreadName("can link");
+
+    std::chrono::milliseconds backoff = MIN_BACKOFF;
+    while (true) {
+        _state.store(State::INITIALIZING, std::memory_order_release);
+        uint32_t attempt = _attempts.fetch_add(1) + 1;
+
+        bool ok;
+        {
+            DASH_TRACE_SCOPE("can_link_init");
+            ok = _bus.init(_baud);
+        }
+
+        if (ok) {
+            _state.store(State::UP, std::memory_order_release);
+            dash::perf::startup::mark("can bus up");
+            okay::Engine.logger.info("CAN bus up after {} attempt(s)", attempt);
+            if (_tick) {
+                pump();
+            }
+            return;
+        }
+
+        _state.store(State::BACKOFF, std::memory_order_release);
+        if (attempt == 1) {
+            okay::Engine.logger.error("Failed to initialize CAN bus, retrying in the background");
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_wake.wait_for(lock, backoff, [this] { return _stopping; })) {
+            _state.store(State::DOWN, std::memory_order_release);
+            return;
+        }
+        lock.unlock();
+
+        // a controller that failed init may be wedged mid-configuration
+        dash::platform::resetCANController();
+        backoff = std::min(backoff * 2, MAX_BACKOFF);
+    }
+}
+
+void CANLink::pump() {
+    // absolute deadlines, so a slow tick doesn't push every later one back
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+    while (true) {
+        {
+            std::lock_guard<dash::platform::RealtimeMutex> bus(_busMutex);
+            DASH_TRACE_SCOPE("can_tick");
+            _tick();
+        }
+
+        next += _period;
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_wake.wait_until(lock, next, [this] { return _stopping; })) {
+            return;
+        }
+    }
+}
+
+const char* canLinkStateName(CANLink::State state) {
+    switch (state) {
+        case CANLink::State::DOWN:
+            return "DOWN";
+        case CANLink::State::INITIALIZING:
+            return "INITIALIZING";
+        case CANLink::State::BACKOFF:
+            return "BACKOFF";
+        case CANLink::State::UP:
+            return "UP";
+    }
+    return "UNKNOWN";
+}
@@ -0,0 +1,76 @@
+#ifndef __CAN_LINK_HPP__
+#define __CAN_LINK_HPP__
+
+#include <nfr_can/CAN_interface.hpp>
+#include <platform/platform.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+// Brings a CAN bus up in the background so the rest of the dash doesn't wait on it. Failed inits
+// reset the controller and retry with exponential backoff. Until the link is UP nothing but its
+// thread may touch the bus.
+//
+// The link runs on the CAN real-time thread. Given a tick through tickOnThread(), it keeps ticking
+// the bus from that thread once UP, so frames are drained on time whatever the main loop is doing;
+// anything else reading the bus's signals does so holding busMutex(). Without one the bus belongs
+// to the main loop once UP and the thread exits.
+class CANLink {
+   public:
+    enum class State : uint8_t {
+        DOWN,
+        INITIALIZING,
+        BACKOFF,
+        UP
+    };
+
+    static constexpr std::chrono::milliseconds MIN_BACKOFF{100};
+    static constexpr std::chrono::milliseconds MAX_BACKOFF{5000};
+    static constexpr std::chrono::microseconds TICK_PERIOD{1000};
+
+    CANLink(CAN_Bus& bus, BaudRate baud) : _bus(bus), _baud(baud) {}
+    ~CANLink() { stop(); }
+
+    CANLink(const CANLink&) = delete;
+    CANLink& operator=(const CANLink&) = delete;
+
+    // call before start(), tick is run under busMutex() every period once the link is UP
+    void tickOnThread(std::function<void()> tick, std::chrono::microseconds period = TICK_PERIOD);
+
+    void start();
+    void stop();
+
+    bool ticksOnThread() const { return static_cast<bool>(_tick); }
+    dash::platform::RealtimeMutex& busMutex() { return _busMutex; }
+
+    bool isUp() const { return _state.load(std::memory_order_acquire) == State::UP; }
+    State state() const { return _state.load(std::memory_order_acquire); }
+    uint32_t attempts() const { return _attempts.load(std::memory_order_relaxed); }
+
+   private:
+    void run();
+    void pump();
+
+    CAN_Bus& _bus;
+    BaudRate _baud;
+
+    std::atomic<State> _state{State::DOWN};
+    std::atomic<uint32_t> _attempts{0};
+
+    std::function<void()> _tick;
+    std::chrono::microseconds _period = TICK_PERIOD;
+    dash::platform::RealtimeMutex _busMutex;
+
+    dash::platform::RealtimeThread _thread;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    bool _stopping = false;
+};
+
+const char* canLinkStateName(CANLink::State state);
+
+#endif  // __CAN_LINK_HPP__
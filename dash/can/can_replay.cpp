@@ -0,0 +1,110 @@
+#include <can/can_replay.hpp>
+#include <okay/core/okay.hpp>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// parses the "<id>#<data>" part of a candump line, false for remote, FD and malformed frames
+static bool __parseFrame(const char* text, CAN_Frame& frame) {
+    const char* hash = std::strchr(text, '#');
+    if (hash == nullptr || hash == text || hash[1] == 'R' || hash[1] == '#') {
+        return false;
+    }
+
+    char* end = nullptr;
+    frame.id = static_cast<uint32_t>(std::strtoul(text, &end, 16));
+    if (end != hash) {
+        return false;
+    }
+    // candump always writes standard ids as 3 digits and extended ones as 8
+    frame.extended = hash - text > 3;
+
+    const char* data = hash + 1;
+    size_t digits = std::strlen(data);
+    if (digits % 2 != 0 || digits / 2 > sizeof(frame.data)) {
+        return false;
+    }
+
+    frame.len = static_cast<uint8_t>(digits / 2);
+    for (size_t i = 0; i < frame.len; i++) {
+        char byte[3] = {data[2 * i], data[2 * i + 1], '\0'};
+        frame.data[i] = static_cast<uint8_t>(std::strtoul(byte, &end, 16));
+        if (end != byte + 2) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CANReplay::load(const char* path) {
+    FILE* file = std::fopen(path, "r");
+    if (file == nullptr) {
+        okay::Engine.logger.error("Unable to open CAN log {}: {}", path, std::strerror(errno));
+        return false;
+    }
+
+    _frames.clear();
+    uint64_t firstNs = 0;
+    size_t skipped = 0;
+
+    char line[256];
+    while (std::fgets(line, sizeof(line), file) != nullptr) {
+        unsigned long long seconds = 0;
+        unsigned long long micros = 0;
+        char text[64];
+        if (std::sscanf(line, " (%llu.%6llu) %*s %63s", &seconds, &micros, text) != 3) {
+            skipped++;
+            continue;
+        }
+
+        CAN_Frame frame{};
+        if (!__parseFrame(text, frame)) {
+            skipped++;
+            continue;
+        }
+
+        uint64_t timeNs = seconds * 1'000'000'000ULL + micros * 1'000ULL;
+        if (_frames.empty()) {
+            firstNs = timeNs;
+        }
+        append(timeNs >= firstNs ? timeNs - firstNs : 0, frame);
+    }
+    std::fclose(file);
+
+    okay::Engine.logger.info("Loaded {} frames from {} ({} lines skipped)",
+                             _frames.size(),
+                             path,
+                             skipped);
+    return !_frames.empty();
+}
+
+void CANReplay::append(uint64_t offsetNs, const CAN_Frame& frame) {
+    // a log that goes back in time is played in file order
+    if (!_frames.empty() && offsetNs < _frames.back().offsetNs) {
+        offsetNs = _frames.back().offsetNs;
+    }
+    _frames.push_back({offsetNs, frame});
+}
+
+bool CANReplay::recv(CAN_Frame& msg) {
+    if (_frames.empty()) {
+        return false;
+    }
+
+    const Entry& entry = _frames[_next];
+    if (_lapStartNs + entry.offsetNs > _nowNs) {
+        return false;
+    }
+
+    msg = entry.frame;
+    if (++_next == _frames.size()) {
+        // the next lap starts a gap after this one ended, so a log shorter than a tick can't keep
+        // a receive loop going forever
+        _next = 0;
+        _lapStartNs += entry.offsetNs + LAP_GAP_NS;
+        _laps++;
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef __CAN_REPLAY_HPP__
+#define __CAN_REPLAY_HPP__
+
+#include <nfr_can/CAN_interface.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Driver that plays a recorded log back instead of talking to a controller. The log is read up
+// front, so playback itself doesn't touch the file or the heap. The replay clock only moves when
+// advance() is called; recv hands out every frame whose offset into the log has passed, and the
+// log starts over once it runs out.
+class CANReplay : public ICAN {
+   public:
+    static constexpr uint64_t LAP_GAP_NS = 1'000'000;
+
+    // reads a `candump -L` log, e.g. "(1436509052.249713) can0 0A3#00FF12". remote frames are
+    // skipped
+    bool load(const char* path);
+
+    // adds a frame offsetNs after the start of the log, for logs built in code
+    void append(uint64_t offsetNs, const CAN_Frame& frame);
+
+    void advance(uint64_t elapsedNs) { _nowNs += elapsedNs; }
+
+    size_t size() const { return _frames.size(); }
+    uint64_t laps() const { return _laps; }
+
+    bool init(const BaudRate baud) override { return !_frames.empty(); }
+    bool send(const CAN_Frame& msg) override { return true; }
+    bool recv(CAN_Frame& msg) override;
+    uint32_t time_ms() override { return static_cast<uint32_t>(_nowNs / 1'000'000); }
+
+   private:
+    struct Entry {
+        uint64_t offsetNs;
+        CAN_Frame frame;
+    };
+
+    std::vector<Entry> _frames;
+    size_t _next = 0;
+    uint64_t _nowNs = 0;
+    uint64_t _lapStartNs = 0;
+    uint64_t _laps = 0;
+};
+
+#endif  // __CAN_REPLAY_HPP__
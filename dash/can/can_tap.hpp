@@ -0,0 +1,41 @@
+#ifndef __CAN_TAP_HPP__
+#define __CAN_TAP_HPP__
+
+#include <can/frame_arrivals.hpp>
+#include <nfr_can/CAN_interface.hpp>
+#include <perf/latency_probe.hpp>
+#include <perf/startup_profiler.hpp>
+
+#include <memory>
+
+// Driver decorator that forwards to the real CAN driver and observes the frames it receives,
+// stamping them for the latency probe as they come off the controller and marking their ids in
+// frameArrivals().
+class CANTap : public ICAN {
+   public:
+    explicit CANTap(std::unique_ptr<ICAN> driver) : _driver(std::move(driver)) {}
+
+    bool init(const BaudRate baud) override { return _driver->init(baud); }
+
+    bool send(const CAN_Frame& msg) override { return _driver->send(msg); }
+
+    bool recv(CAN_Frame& msg) override {
+        if (!_driver->recv(msg)) {
+            return false;
+        }
+
+        dash::perf::latency::onFrameArrival(msg.id, dash::perf::latency::nowNs());
+        dash::perf::startup::milestone(dash::perf::startup::Milestone::FIRST_CAN_FRAME);
+        if (!msg.extended) {
+            dash::frameArrivals().mark(msg.id);
+        }
+        return true;
+    }
+
+    uint32_t time_ms() override { return _driver->time_ms(); }
+
+   private:
+    std::unique_ptr<ICAN> _driver;
+};
+
+#endif  // __CAN_TAP_HPP__
@@ -0,0 +1,243 @@
+#ifndef __CELL_STATS_HPP__
+#define __CELL_STATS_HPP__
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Reduction over a contiguous array of cell readings: min, max and where they are, mean and
+// (population) standard deviation. Ties on min/max report the lowest index.
+namespace dash {
+
+struct CellStats {
+    float min = 0.0f;
+    float max = 0.0f;
+    float mean = 0.0f;
+    float stddev = 0.0f;
+    uint16_t argmin = 0;
+    uint16_t argmax = 0;
+
+    float spread() const { return max - min; }
+};
+
+inline CellStats reduceCellsScalar(const float* cells, size_t count) {
+    CellStats stats{};
+    if (count == 0) {
+        return stats;
+    }
+
+    stats.min = cells[0];
+    stats.max = cells[0];
+    float sum = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        if (cells[i] < stats.min) {
+            stats.min = cells[i];
+            stats.argmin = static_cast<uint16_t>(i);
+        }
+        if (cells[i] > stats.max) {
+            stats.max = cells[i];
+            stats.argmax = static_cast<uint16_t>(i);
+        }
+        sum += cells[i];
+    }
+    stats.mean = sum / static_cast<float>(count);
+
+    // second pass around the mean, sum(x^2) - n*mean^2 cancels away millivolt spreads in a float
+    float squares = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        float d = cells[i] - stats.mean;
+        squares += d * d;
+    }
+    stats.stddev = std::sqrt(squares / static_cast<float>(count));
+    return stats;
+}
+
+namespace detail {
+
+// per-lane results of a 4 wide pass, folded into stats together with the scalar tail
+struct CellLanes {
+    float min[4];
+    float max[4];
+    uint32_t argmin[4];
+    uint32_t argmax[4];
+    float sum;
+};
+
+inline float foldLanes(const CellLanes& lanes, const float* cells, size_t from, size_t count,
+                       CellStats& stats) {
+    stats.min = lanes.min[0];
+    stats.max = lanes.max[0];
+    uint32_t argmin = lanes.argmin[0];
+    uint32_t argmax = lanes.argmax[0];
+    for (size_t lane = 1; lane < 4; lane++) {
+        if (lanes.min[lane] < stats.min ||
+            (lanes.min[lane] == stats.min && lanes.argmin[lane] < argmin)) {
+            stats.min = lanes.min[lane];
+            argmin = lanes.argmin[lane];
+        }
+        if (lanes.max[lane] > stats.max ||
+            (lanes.max[lane] == stats.max && lanes.argmax[lane] < argmax)) {
+            stats.max = lanes.max[lane];
+            argmax = lanes.argmax[lane];
+        }
+    }
+
+    float sum = lanes.sum;
+    for (size_t i = from; i < count; i++) {
+        if (cells[i] < stats.min) {
+            stats.min = cells[i];
+            argmin = static_cast<uint32_t>(i);
+        }
+        if (cells[i] > stats.max) {
+            stats.max = cells[i];
+            argmax = static_cast<uint32_t>(i);
+        }
+        sum += cells[i];
+    }
+
+    stats.argmin = static_cast<uint16_t>(argmin);
+    stats.argmax = static_cast<uint16_t>(argmax);
+    return sum;
+}
+
+}  // namespace detail
+
+#if defined(__aarch64__)
+
+// 4 cells per iteration, each lane keeps its own min/max and the index it came from; the strict
+// compares keep a lane's first index on ties
+inline CellStats reduceCells(const float* cells, size_t count) {
+    if (count < 4) {
+        return reduceCellsScalar(cells, count);
+    }
+
+    static const uint32_t FIRST[4] = {0, 1, 2, 3};
+    float32x4_t vmin = vld1q_f32(cells);
+    float32x4_t vmax = vmin;
+    float32x4_t vsum = vmin;
+    uint32x4_t idx = vld1q_u32(FIRST);
+    uint32x4_t imin = idx;
+    uint32x4_t imax = idx;
+    const uint32x4_t four = vdupq_n_u32(4);
+
+    const size_t vectorEnd = count & ~size_t{3};
+    for (size_t i = 4; i < vectorEnd; i += 4) {
+        float32x4_t v = vld1q_f32(cells + i);
+        idx = vaddq_u32(idx, four);
+
+        uint32x4_t lt = vcltq_f32(v, vmin);
+        uint32x4_t gt = vcgtq_f32(v, vmax);
+        vmin = vbslq_f32(lt, v, vmin);
+        vmax = vbslq_f32(gt, v, vmax);
+        imin = vbslq_u32(lt, idx, imin);
+        imax = vbslq_u32(gt, idx, imax);
+        vsum = vaddq_f32(vsum, v);
+    }
+
+    detail::CellLanes lanes;
+    vst1q_f32(lanes.min, vmin);
+    vst1q_f32(lanes.max, vmax);
+    vst1q_u32(lanes.argmin, imin);
+    vst1q_u32(lanes.argmax, imax);
+    lanes.sum = vaddvq_f32(vsum);
+
+    CellStats stats{};
+    float sum = detail::foldLanes(lanes, cells, vectorEnd, count, stats);
+    stats.mean = sum / static_cast<float>(count);
+
+    const float32x4_t mean = vdupq_n_f32(stats.mean);
+    float32x4_t vsquares = vdupq_n_f32(0.0f);
+    for (size_t j = 0; j < vectorEnd; j += 4) {
+        float32x4_t d = vsubq_f32(vld1q_f32(cells + j), mean);
+        vsquares = vfmaq_f32(vsquares, d, d);
+    }
+    float squares = vaddvq_f32(vsquares);
+    for (size_t j = vectorEnd; j < count; j++) {
+        float d = cells[j] - stats.mean;
+        squares += d * d;
+    }
+    stats.stddev = std::sqrt(squares / static_cast<float>(count));
+    return stats;
+}
+
+#elif defined(__SSE2__)
+
+// same as the NEON version, SSE2 has no blend so the selects are and/andnot/or
+inline CellStats reduceCells(const float* cells, size_t count) {
+    if (count < 4) {
+        return reduceCellsScalar(cells, count);
+    }
+
+    auto select = [](__m128i mask, __m128i a, __m128i b) {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    };
+
+    __m128 vmin = _mm_loadu_ps(cells);
+    __m128 vmax = vmin;
+    __m128 vsum = vmin;
+    __m128i idx = _mm_setr_epi32(0, 1, 2, 3);
+    __m128i imin = idx;
+    __m128i imax = idx;
+    const __m128i four = _mm_set1_epi32(4);
+
+    const size_t vectorEnd = count & ~size_t{3};
+    for (size_t i = 4; i < vectorEnd; i += 4) {
+        __m128 v = _mm_loadu_ps(cells + i);
+        idx = _mm_add_epi32(idx, four);
+
+        __m128 lt = _mm_cmplt_ps(v, vmin);
+        __m128 gt = _mm_cmpgt_ps(v, vmax);
+        vmin = _mm_or_ps(_mm_and_ps(lt, v), _mm_andnot_ps(lt, vmin));
+        vmax = _mm_or_ps(_mm_and_ps(gt, v), _mm_andnot_ps(gt, vmax));
+        imin = select(_mm_castps_si128(lt), idx, imin);
+        imax = select(_mm_castps_si128(gt), idx, imax);
+        vsum = _mm_add_ps(vsum, v);
+    }
+
+    detail::CellLanes lanes;
+    float sums[4];
+    _mm_storeu_ps(lanes.min, vmin);
+    _mm_storeu_ps(lanes.max, vmax);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes.argmin), imin);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes.argmax), imax);
+    _mm_storeu_ps(sums, vsum);
+    lanes.sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+
+    CellStats stats{};
+    float sum = detail::foldLanes(lanes, cells, vectorEnd, count, stats);
+    stats.mean = sum / static_cast<float>(count);
+
+    const __m128 mean = _mm_set1_ps(stats.mean);
+    __m128 vsquares = _mm_setzero_ps();
+    for (size_t j = 0; j < vectorEnd; j += 4) {
+        __m128 d = _mm_sub_ps(_mm_loadu_ps(cells + j), mean);
+        vsquares = _mm_add_ps(vsquares, _mm_mul_ps(d, d));
+    }
+    float squareLanes[4];
+    _mm_storeu_ps(squareLanes, vsquares);
+    float squares = (squareLanes[0] + squareLanes[1]) + (squareLanes[2] + squareLanes[3]);
+    for (size_t j = vectorEnd; j < count; j++) {
+        float d = cells[j] - stats.mean;
+        squares += d * d;
+    }
+    stats.stddev = std::sqrt(squares / static_cast<float>(count));
+    return stats;
+}
+
+#else
+
+inline CellStats reduceCells(const float* cells, size_t count) {
+    return reduceCellsScalar(cells, count);
+}
+
+#endif
+
+}  // namespace dash
+
+#endif  // __CELL_STATS_HPP__
@@ -0,0 +1,169 @@
+#ifndef __DERIVED_DBC_HPP__
+#define __DERIVED_DBC_HPP__
+
+// Computed channels that aren't on the bus. They're laid out like the generated can_dbc.hpp, a
+// message per channel with its own id and a meta table of names, so anything that walks messages
+// and looks names up by (message id, signal index) shows them next to bus signals. Their messages
+// sit on a bus of their own that is never ticked; the values come from the DerivedSignals engine,
+// see SIGNALS below.
+
+#include <can/can_dbc.hpp>
+#include <can/derived_signals.hpp>
+
+#include <map>
+#include <utility>
+
+namespace dbc {
+
+inline CAN_Bus derivedBus;
+
+namespace derived {
+
+namespace packPower {
+
+// kW, positive while discharging
+inline CAN_Signal_FLOAT power = MakeSignalSigned(float, 0, 32, 1.0, 0.0, false);
+inline RX_CAN_Message(1) message{derivedBus, 0x700, false, 4, power};
+
+inline float compute() {
+    return bmsSoe::batteryVoltage.get() * bmsSoe::batteryCurrent.get() / 1000.0f;
+}
+
+}  // namespace packPower
+
+namespace inverterEnergy {
+
+// summed over the rear and both front inverters
+inline CAN_Signal_FLOAT whDrawn = MakeSignalSigned(float, 0, 32, 1.0, 0.0, false);
+inline CAN_Signal_FLOAT whCharged = MakeSignalSigned(float, 32, 32, 1.0, 0.0, false);
+inline RX_CAN_Message(2) message{derivedBus, 0x701, false, 8, whDrawn, whCharged};
+
+inline float computeDrawn() {
+    return static_cast<float>(rearInverterPowerDraw::whDrawn.get()) +
+           static_cast<float>(frontLeftInverterPowerDraw::whDrawn.get()) +
+           static_cast<float>(frontRightInverterPowerDraw::whDrawn.get());
+}
+
+inline float computeCharged() {
+    return static_cast<float>(rearInverterPowerDraw::whCharged.get()) +
+           static_cast<float>(frontLeftInverterPowerDraw::whCharged.get()) +
+           static_cast<float>(frontRightInverterPowerDraw::whCharged.get());
+}
+
+}  // namespace inverterEnergy
+
+namespace inverterNetEnergy {
+
+inline CAN_Signal_FLOAT whNet = MakeSignalSigned(float, 0, 32, 1.0, 0.0, false);
+inline RX_CAN_Message(1) message{derivedBus, 0x702, false, 4, whNet};
+
+inline float compute() {
+    return inverterEnergy::whDrawn.get() - inverterEnergy::whCharged.get();
+}
+
+}  // namespace inverterNetEnergy
+
+namespace torqueSplit {
+
+// share of the commanded current going to the front inverters, in percent
+inline CAN_Signal_FLOAT front = MakeSignalSigned(float, 0, 32, 1.0, 0.0, false);
+inline RX_CAN_Message(1) message{derivedBus, 0x703, false, 4, front};
+
+inline float compute() {
+    float frontCurrent = static_cast<float>(ecuSetCurrentFrontLeftInverter::setCurrent.get()) +
+                         static_cast<float>(ecuSetCurrentFrontRightInverter::setCurrent.get());
+    float total = frontCurrent + static_cast<float>(ecuSetCurrentRearInverter::setCurrent.get());
+    return total > 0.0f ? 100.0f * frontCurrent / total : 0.0f;
+}
+
+}  // namespace torqueSplit
+
+namespace brakeBias {
+
+// share of the brake pressure on the front axle, in percent
+inline CAN_Signal_FLOAT front = MakeSignalSigned(float, 0, 32, 1.0, 0.0, false);
+inline RX_CAN_Message(1) message{derivedBus, 0x704, false, 4, front};
+
+inline float compute() {
+    float frontPressure = static_cast<float>(ecuBrake::frontBrakePressure.get());
+    float total = frontPressure + static_cast<float>(ecuBrake::rearBrakePressure.get());
+    return total > 0.0f ? 100.0f * frontPressure / total : 0.0f;
+}
+
+}  // namespace brakeBias
+
+// clang-format off
+inline const dash::DerivedSignal SIGNALS[] = {
+    {.output = &packPower::power,
+     .compute = packPower::compute,
+     .inputs = {&bmsSoe::batteryVoltage, &bmsSoe::batteryCurrent}},
+    {.output = &inverterEnergy::whDrawn,
+     .compute = inverterEnergy::computeDrawn,
+     .inputs = {&rearInverterPowerDraw::whDrawn, &frontLeftInverterPowerDraw::whDrawn,
+                &frontRightInverterPowerDraw::whDrawn}},
+    {.output = &inverterEnergy::whCharged,
+     .compute = inverterEnergy::computeCharged,
+     .inputs = {&rearInverterPowerDraw::whCharged, &frontLeftInverterPowerDraw::whCharged,
+                &frontRightInverterPowerDraw::whCharged}},
+    {.output = &inverterNetEnergy::whNet,
+     .compute = inverterNetEnergy::compute,
+     .inputs = {&inverterEnergy::whDrawn, &inverterEnergy::whCharged}},
+    {.output = &torqueSplit::front,
+     .compute = torqueSplit::compute,
+     .inputs = {&ecuSetCurrentFrontLeftInverter::setCurrent,
+                &ecuSetCurrentFrontRightInverter::setCurrent,
+                &ecuSetCurrentRearInverter::setCurrent}},
+    {.output = &brakeBias::front,
+     .compute = brakeBias::compute,
+     .inputs = {&ecuBrake::frontBrakePressure, &ecuBrake::rearBrakePressure}},
+};
+// clang-format on
+
+namespace meta {
+
+static const std::map<uint32_t, const char*> messageIdToName = {
+    { 0x700, "Derived_Pack_Power" },
+    { 0x701, "Derived_Inverter_Energy" },
+    { 0x702, "Derived_Inverter_Net_Energy" },
+    { 0x703, "Derived_Torque_Split" },
+    { 0x704, "Derived_Brake_Bias" },
+};
+
+static const std::map<std::pair<uint32_t, uint8_t>, const char*> signalIdToName = {
+    { { 0x700, 0 }, "Pack_Power_kW" },
+    { { 0x701, 0 }, "Inverter_Wh_Drawn" },
+    { { 0x701, 1 }, "Inverter_Wh_Charged" },
+    { { 0x702, 0 }, "Inverter_Wh_Net" },
+    { { 0x703, 0 }, "Torque_Split_Front" },
+    { { 0x704, 0 }, "Brake_Bias_Front" },
+};
+
+}  // namespace meta
+
+}  // namespace derived
+
+// Name of a signal by (message id, signal index), generated or derived, nullptr if it has none.
+inline const char* signalName(std::pair<uint32_t, uint8_t> signalId) {
+    auto it = meta::signalIdToName.find(signalId);
+    if (it != meta::signalIdToName.end()) return it->second;
+
+    it = derived::meta::signalIdToName.find(signalId);
+    if (it != derived::meta::signalIdToName.end()) return it->second;
+
+    return nullptr;
+}
+
+// Name of a message by id, generated or derived, nullptr if it has none.
+inline const char* messageName(uint32_t messageId) {
+    auto it = meta::messageIdToName.find(messageId);
+    if (it != meta::messageIdToName.end()) return it->second;
+
+    it = derived::meta::messageIdToName.find(messageId);
+    if (it != derived::meta::messageIdToName.end()) return it->second;
+
+    return nullptr;
+}
+
+}  // namespace dbc
+
+#endif  // __DERIVED_DBC_HPP__
@@ -0,0 +1,171 @@
+#ifndef __DERIVED_SIGNALS_HPP__
+#define __DERIVED_SIGNALS_HPP__
+
+#include <nfr_can/CAN_interface.hpp>
+#include <okay/core/okay.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+
+namespace dash {
+
+// A value computed from decoded signals and published on a signal of its own. compute reads its
+// inputs directly; inputs lists them (bus signals or other derived outputs), so the engine knows
+// when compute has to run again.
+struct DerivedSignal {
+    static constexpr size_t MAX_INPUTS = 4;
+
+    CAN_Signal_FLOAT* output;
+    float (*compute)();
+    std::array<ICAN_Signal*, MAX_INPUTS> inputs{};
+};
+
+// Evaluates a table of derived signals as a dependency graph. Every bus signal feeding the table is
+// watched once, however many derived signals read it. When it changes, only the derived signals
+// depending on it are recomputed, and an output that changed marks its own dependents in turn.
+// An input that is the output of an earlier entry becomes an edge of the graph, so table order is
+// a topological order and one pass settles it. An output of a later entry is watched like a bus
+// signal and lags a frame.
+class DerivedSignals {
+   public:
+    static constexpr size_t MAX_NODES = 16;
+    static constexpr size_t MAX_SOURCES = 32;
+
+    void attach(std::span<const DerivedSignal> table) {
+        _nodeCount = 0;
+        _sourceCount = 0;
+        _dirty = 0;
+
+        for (const DerivedSignal& signal : table) {
+            if (_nodeCount == MAX_NODES) {
+                okay::Engine.logger.error("Too many derived signals, ignoring the rest");
+                break;
+            }
+
+            size_t index = _nodeCount++;
+            Node& node = _nodes[index];
+            node = Node{};
+            node.signal = signal;
+
+            for (ICAN_Signal* input : signal.inputs) {
+                if (input == nullptr) continue;
+
+                Node* producer = findNode(input, index);
+                if (producer != nullptr) {
+                    producer->dependents |= bit(index);
+                    continue;
+                }
+
+                Source* source = findSource(input);
+                if (source == nullptr) {
+                    okay::Engine.logger.error(
+                        "Too many derived signal inputs, entry {} won't update", index);
+                    continue;
+                }
+                source->dependents |= bit(index);
+            }
+
+            // computed once up front, whether or not its inputs ever change
+            _dirty |= bit(index);
+        }
+    }
+
+    // returns the number of derived signals that were recomputed
+    size_t evaluate() {
+        for (size_t i = 0; i < _sourceCount; i++) {
+            Source& source = _sources[i];
+            double value = readSignal(source.signal);
+            if (sameValue(value, source.lastValue)) continue;
+            source.lastValue = value;
+            _dirty |= source.dependents;
+        }
+
+        size_t recomputed = 0;
+        for (size_t i = 0; _dirty != 0 && i < _nodeCount; i++) {
+            if (!(_dirty & bit(i))) continue;
+            _dirty &= ~bit(i);
+
+            Node& node = _nodes[i];
+            float value = node.signal.compute();
+            recomputed++;
+
+            if (sameValue(value, node.lastValue)) continue;
+            node.lastValue = value;
+            node.signal.output->set(SignalType::FLOAT, &value);
+            _dirty |= node.dependents;
+        }
+
+        _recomputeCount += recomputed;
+        return recomputed;
+    }
+
+    size_t size() const { return _nodeCount; }
+    uint64_t recomputeCount() const { return _recomputeCount; }
+
+   private:
+    struct Node {
+        DerivedSignal signal{};
+        uint32_t dependents = 0;
+        float lastValue = NAN;
+    };
+
+    struct Source {
+        ICAN_Signal* signal = nullptr;
+        uint32_t dependents = 0;
+        double lastValue = NAN;
+    };
+
+    static constexpr uint32_t bit(size_t index) { return 1u << index; }
+
+    static bool sameValue(double a, double b) {
+        return a == b || (std::isnan(a) && std::isnan(b));
+    }
+
+    static double readSignal(ICAN_Signal* signal) {
+        switch (signal->getSignalType()) {
+            case SignalType::INT8:   return static_cast<CAN_Signal<int8_t>*>(signal)->get();
+            case SignalType::INT16:  return static_cast<CAN_Signal<int16_t>*>(signal)->get();
+            case SignalType::INT32:  return static_cast<CAN_Signal<int32_t>*>(signal)->get();
+            case SignalType::INT64:  return static_cast<CAN_Signal<int64_t>*>(signal)->get();
+            case SignalType::UINT8:  return static_cast<CAN_Signal<uint8_t>*>(signal)->get();
+            case SignalType::UINT16: return static_cast<CAN_Signal<uint16_t>*>(signal)->get();
+            case SignalType::UINT32: return static_cast<CAN_Signal<uint32_t>*>(signal)->get();
+            case SignalType::UINT64: return static_cast<CAN_Signal<uint64_t>*>(signal)->get();
+            case SignalType::FLOAT:  return static_cast<CAN_Signal<float>*>(signal)->get();
+            case SignalType::BOOL:   return static_cast<CAN_Signal<bool>*>(signal)->get();
+        }
+        return NAN;
+    }
+
+    Node* findNode(ICAN_Signal* output, size_t before) {
+        for (size_t i = 0; i < before; i++) {
+            if (_nodes[i].signal.output == output) return &_nodes[i];
+        }
+        return nullptr;
+    }
+
+    Source* findSource(ICAN_Signal* signal) {
+        for (size_t i = 0; i < _sourceCount; i++) {
+            if (_sources[i].signal == signal) return &_sources[i];
+        }
+        if (_sourceCount == MAX_SOURCES) return nullptr;
+
+        Source& source = _sources[_sourceCount++];
+        source = Source{};
+        source.signal = signal;
+        return &source;
+    }
+
+    std::array<Node, MAX_NODES> _nodes{};
+    std::array<Source, MAX_SOURCES> _sources{};
+    size_t _nodeCount = 0;
+    size_t _sourceCount = 0;
+    uint32_t _dirty = 0;
+    uint64_t _recomputeCount = 0;
+};
+
+}  // namespace dash
+
+#endif  // __DERIVED_SIGNALS_HPP__
@@ -0,0 +1,39 @@
+#ifndef __FRAME_ARRIVALS_HPP__
+#define __FRAME_ARRIVALS_HPP__
+
+#include <array>
+#include <cstdint>
+
+namespace dash {
+
+// Standard ids of the frames received since the last clear, marked by CANTap as they come off the
+// driver. tick_bus decodes a frame as it receives it, so once tick_bus returns, the signals of a
+// marked id hold that frame's values; consumers that only care about a few messages can look at
+// those instead of polling every signal.
+class FrameArrivals {
+   public:
+    static constexpr uint32_t MAX_ID = 0x7FF;
+
+    void mark(uint32_t id) {
+        if (id <= MAX_ID) {
+            _bits[id / 64] |= 1ULL << (id % 64);
+        }
+    }
+
+    bool test(uint32_t id) const { return id <= MAX_ID && (_bits[id / 64] >> (id % 64)) & 1; }
+
+    void clear() { _bits.fill(0); }
+
+   private:
+    std::array<uint64_t, (MAX_ID + 1) / 64> _bits{};
+};
+
+// arrivals on the drive bus, only touched holding the CAN link's bus mutex
+inline FrameArrivals& frameArrivals() {
+    static FrameArrivals s_arrivals;
+    return s_arrivals;
+}
+
+}  // namespace dash
+
+#endif  // __FRAME_ARRIVALS_HPP__
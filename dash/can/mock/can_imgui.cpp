@@ -1,5 +1,6 @@
 #include "can_imgui.hpp"
-#include "can/can_dbc.hpp"
+#include "can/derived_dbc.hpp"
+#include "can/frame_arrivals.hpp"
 #include <string.h>
 #include <imgui.h>
 #include <nfr_can/CAN_interface.hpp>
@@ -11,18 +12,22 @@
 
 
 bool CAN_IMGUI::init(const BaudRate baud) {
-    for (ICAN_Message* message : dbc::driveBus.get_messages()) {
-        uint32_t messageId { message->get_id().id };
+    // the derived channels are listed (and editable) next to the bus they're computed from
+    for (CAN_Bus* bus : {&dbc::driveBus, &dbc::derivedBus}) {
+        for (ICAN_Message* message : bus->get_messages()) {
+            uint32_t messageId { message->get_id().id };
 
-        const char* msgName { dbc::meta::messageIdToName.at(messageId) };
-        std::string_view nameView { msgName };
+            const char* msgName { dbc::messageName(messageId) };
+            if (msgName == nullptr) continue;
+            std::string_view nameView { msgName };
 
-        size_t firstUnderscore { nameView.find('_') };
-        std::string_view board { (firstUnderscore != std::string::npos) 
-                                    ? nameView.substr(0, firstUnderscore) 
-                                    : nameView };
+            size_t firstUnderscore { nameView.find('_') };
+            std::string_view board { (firstUnderscore != std::string::npos) 
+                                        ? nameView.substr(0, firstUnderscore) 
+                                        : nameView };
 
-        sortedMessages.push_back({board, messageId});
+            sortedMessages.push_back({std::string{board}, bus, messageId});
+        }
     }
 
     std::sort(sortedMessages.begin(), sortedMessages.end(), 
@@ -43,7 +48,7 @@ bool CAN_IMGUI::recv(CAN_Frame& msg) {
 
     MessageChangeInfo info { changeInfoOpt.value() };
 
-    ICAN_Message* message { dbc::driveBus.get_message_from_id(info.messageID) };
+    ICAN_Message* message { info.bus->get_message_from_id(info.messageID) };
     ICAN_Signal* signal { message->get_signal(info.signalNum) };
 
     switch (info.changedSignal.type) {
@@ -61,6 +66,12 @@ bool CAN_IMGUI::recv(CAN_Frame& msg) {
 
     message->encode_to_frame(msg);
 
+    // the signal was written directly rather than received, so CANTap never sees a frame; mark
+    // it here so arrival-driven consumers like the pack stats still pick the edit up
+    if (info.bus == &dbc::driveBus) {
+        dash::frameArrivals().mark(info.messageID);
+    }
+
     timeSinceStartup += okay::Engine.time->deltaTimeMs();
     
     return false;
@@ -84,22 +95,20 @@ okay::Option<CAN_IMGUI::MessageChangeInfo> CAN_IMGUI::drawUI() {
     auto result { okay::Option<CAN_IMGUI::MessageChangeInfo>::none() };
 
     if (ImGui::BeginTabBar("CAN_Boards")) {
-        std::string_view currentBoard {};
+        const std::string* currentBoard {};
         bool tabOpen {};
 
         bool expandAll { filterChanged };
         bool collapseAll {};
 
         for (const GroupedMessage& item : sortedMessages) {
-            if (item.boardName != currentBoard) {
+            if (currentBoard == nullptr || item.boardName != *currentBoard) {
                 if (tabOpen) {
                     ImGui::EndTabItem();
                 }
-                currentBoard = item.boardName;
-
-                std::string tabName { currentBoard };
+                currentBoard = &item.boardName;
 
-                tabOpen = ImGui::BeginTabItem(tabName.c_str());
+                tabOpen = ImGui::BeginTabItem(currentBoard->c_str());
 
                 if (tabOpen) {
                     expandAll = ImGui::Button("Expand All");
@@ -110,8 +119,8 @@ okay::Option<CAN_IMGUI::MessageChangeInfo> CAN_IMGUI::drawUI() {
 
             if (tabOpen) {
                 uint32_t messageID { item.messageID };
-                ICAN_Message* message { dbc::driveBus.get_message_from_id(messageID) };
-                const char* msgName { dbc::meta::messageIdToName.at(messageID) };
+                ICAN_Message* message { item.bus->get_message_from_id(messageID) };
+                const char* msgName { dbc::messageName(messageID) };
 
                 bool showHeader {};
 
@@ -120,10 +129,8 @@ okay::Option<CAN_IMGUI::MessageChangeInfo> CAN_IMGUI::drawUI() {
                 } else {
                     for (uint8_t sigNum {}; sigNum < message->get_num_signals(); ++sigNum) {
                         auto sigID { std::pair{messageID, sigNum} };
-                        auto it { dbc::meta::signalIdToName.find(sigID) };
-                        const char* peekName { (it != dbc::meta::signalIdToName.end())
-                                                ? it->second
-                                                : "(unknown)" };
+                        const char* peekName { dbc::signalName(sigID) };
+                        if (peekName == nullptr) peekName = "(unknown)";
                         
                         if (filter.PassFilter(peekName)) {
                             showHeader = true;
@@ -147,9 +154,8 @@ okay::Option<CAN_IMGUI::MessageChangeInfo> CAN_IMGUI::drawUI() {
                         ICAN_Signal* signal { message->get_signal(sigNum) };
 
                         auto sigId { std::pair{messageID, sigNum} };
-                        const char* name { "(unknown)" };
-                        auto it { dbc::meta::signalIdToName.find(sigId) };
-                        if (it != dbc::meta::signalIdToName.end()) name = it->second;
+                        const char* name { dbc::signalName(sigId) };
+                        if (name == nullptr) name = "(unknown)";
 
                         if (!filter.PassFilter(name) && !filter.PassFilter(msgName)) {
                             continue;
@@ -182,7 +188,7 @@ okay::Option<CAN_IMGUI::MessageChangeInfo> CAN_IMGUI::drawUI() {
                         ImGui::PopID();
 
                         if (changed) {
-                            result = okay::Option<CAN_IMGUI::MessageChangeInfo>::some({ messageID, sigNum, sigInfo });
+                            result = okay::Option<CAN_IMGUI::MessageChangeInfo>::some({ item.bus, messageID, sigNum, sigInfo });
                         }
                     }
 
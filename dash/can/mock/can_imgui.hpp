@@ -2,6 +2,8 @@
 #define __CAN_IMGUI_H__
 
 #include <cstdint>
+#include <string>
+#include <vector>
 #include <nfr_can/CAN_interface.hpp>
 #include <okay/core/util/option.hpp>
 
@@ -24,13 +26,15 @@ class CAN_IMGUI : public ICAN {
     };
 
     struct MessageChangeInfo {
+        CAN_Bus* bus;
         uint32_t messageID;
         uint8_t signalNum;
         SignalInfo changedSignal;
     };
 
     struct GroupedMessage {
-        std::string_view boardName;
+        std::string boardName;  // owned so it can be handed to ImGui without a per-frame copy
+        CAN_Bus* bus;
         uint32_t messageID;
     };
     
@@ -0,0 +1,141 @@
+#ifndef __PACK_STATS_HPP__
+#define __PACK_STATS_HPP__
+
+#include <can/cell_stats.hpp>
+#include <can/frame_arrivals.hpp>
+#include <nfr_can/CAN_interface.hpp>
+#include <okay/core/okay.hpp>
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+
+namespace dash {
+
+// A set of cell readings spread over FRAMES consecutive message ids, PER_FRAME float signals at
+// the start of each. The readings are kept in one contiguous array. A frame's signals are copied
+// into it only in the tick that frame arrived, and the array is reduced again only when a copy
+// changed something. A tick therefore costs the frames that came in, not a read of every signal.
+// Stats are only reported once every frame has been seen at least once.
+template <size_t FRAMES, size_t PER_FRAME>
+class CellBank {
+   public:
+    static constexpr size_t NUM_FRAMES = FRAMES;
+    static constexpr size_t NUM_CELLS = FRAMES * PER_FRAME;
+
+    void attach(CAN_Bus& bus, uint32_t firstId) {
+        _firstId = firstId;
+        _seen = 0;
+        _complete = false;
+        _stale = false;
+
+        for (size_t frame = 0; frame < FRAMES; frame++) {
+            ICAN_Message* message = bus.get_message_from_id(firstId + frame);
+            if (message == nullptr || message->get_num_signals() < PER_FRAME) {
+                okay::Engine.logger.error("No cell message with id {:#x}", firstId + frame);
+                continue;
+            }
+
+            for (size_t k = 0; k < PER_FRAME; k++) {
+                ICAN_Signal* signal = message->get_signal(static_cast<uint8_t>(k));
+                if (signal->getSignalType() == SignalType::FLOAT) {
+                    _signals[frame * PER_FRAME + k] = static_cast<CAN_Signal_FLOAT*>(signal);
+                }
+            }
+        }
+    }
+
+    // copies in the signals of the frames that arrived. Call after tick_bus, holding the bus
+    // mutex; the reduce itself is left to reduce() so it can run without it
+    void collect(const FrameArrivals& arrivals) {
+        for (size_t frame = 0; frame < FRAMES; frame++) {
+            if (!arrivals.test(_firstId + frame)) continue;
+            _seen |= 1u << frame;
+
+            for (size_t i = frame * PER_FRAME; i < (frame + 1) * PER_FRAME; i++) {
+                if (_signals[i] == nullptr) continue;
+                float value = _signals[i]->get();
+                if (value != _cells[i]) {
+                    _cells[i] = value;
+                    _stale = true;
+                }
+            }
+        }
+
+        if (!_complete) {
+            _complete = _seen == ALL_FRAMES;
+            _stale = _complete;
+        }
+    }
+
+    // returns true when the stats changed since the last call
+    bool reduce() {
+        if (!_stale) {
+            return false;
+        }
+
+        _stale = false;
+        _stats = reduceCells(_cells.data(), NUM_CELLS);
+        return true;
+    }
+
+    bool complete() const { return _complete; }
+    size_t framesSeen() const { return static_cast<size_t>(std::popcount(_seen)); }
+    const CellStats& stats() const { return _stats; }
+    std::span<const float> cells() const { return _cells; }
+
+   private:
+    static_assert(FRAMES < 32, "frames seen are tracked in a 32 bit mask");
+    static constexpr uint32_t ALL_FRAMES = (1u << FRAMES) - 1;
+
+    alignas(16) std::array<float, NUM_CELLS> _cells{};
+    std::array<CAN_Signal_FLOAT*, NUM_CELLS> _signals{};
+    CellStats _stats{};
+    uint32_t _firstId = 0;
+    uint32_t _seen = 0;
+    bool _complete = false;
+    bool _stale = false;
+};
+
+// Pack-wide cell voltage and temperature statistics from the BMS cell frames: 140 voltages, 7 per
+// frame from BMS_Voltages_0 (0x153), and 80 temperatures, 8 per frame from BMS_Temperatures_0
+// (0x167). Unlike BMS_Status's min/max this also says which cell it is, and gives the mean and
+// spread of the whole pack.
+class PackStats {
+   public:
+    static constexpr uint32_t VOLTAGES_ID = 0x153;
+    static constexpr uint32_t TEMPERATURES_ID = 0x167;
+
+    using Voltages = CellBank<20, 7>;
+    using Temperatures = CellBank<10, 8>;
+
+    void attach(CAN_Bus& bus) {
+        _voltages.attach(bus, VOLTAGES_ID);
+        _temperatures.attach(bus, TEMPERATURES_ID);
+    }
+
+    // holding the bus mutex, see CellBank::collect
+    void collect(const FrameArrivals& arrivals) {
+        _voltages.collect(arrivals);
+        _temperatures.collect(arrivals);
+    }
+
+    // returns true when either set of stats changed
+    bool reduce() {
+        bool changed = _voltages.reduce();
+        changed |= _temperatures.reduce();
+        return changed;
+    }
+
+    const Voltages& voltages() const { return _voltages; }
+    const Temperatures& temperatures() const { return _temperatures; }
+
+   private:
+    Voltages _voltages;
+    Temperatures _temperatures;
+};
+
+}  // namespace dash
+
+#endif  // __PACK_STATS_HPP__
@@ -0,0 +1,188 @@
+#ifndef __ANIMATION_HPP__
+#define __ANIMATION_HPP__
+
+#include <io/lights.hpp>
+#include <platform/color.hpp>
+#include <glm/glm.hpp>
+#include <okay/core/okay.hpp>
+#include <okay/core/tween/okay_tween.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace dash {
+
+// Declarative description of what a bar shows. A gradient of up to three stops is laid across the
+// bar, the kind decides how it moves.
+struct Animation {
+    enum class Kind : uint8_t {
+        GRADIENT,  // static
+        PULSE,     // brightness follows a sine over the period
+        CHASE,     // one pixel of the gradient lit at a time, walking along the bar
+        BLINK      // on for dutyPercent of the period, off for the rest
+    };
+
+    Kind kind = Kind::GRADIENT;
+    std::array<glm::vec4, 3> stops{};
+    uint32_t periodMs = 1000;
+    uint8_t dutyPercent = 50;
+};
+
+// Plays animations on NeopixelManager's bars. Each animation is compiled once, when it's played,
+// into a per-bar table of packed colors sampled every STEP_MS. Periods too long for MAX_FRAMES
+// samples that far apart get a coarser step of their own. Updating is an integer divide into that
+// table, and a bar is only touched when its frame index or the master brightness changed.
+class AnimationEngine {
+   public:
+    static constexpr uint32_t STEP_MS = 10;
+    static constexpr uint32_t MAX_FRAMES = 1024;
+    static constexpr size_t NUM_BARS = 5;
+
+    // the display whose bars are played on, set before anything is played
+    void attach(NeopixelManager& display) { _display = &display; }
+
+    void play(uint8_t bar, const Animation& animation, uint32_t nowMs) {
+        compile(_slots[bar], animation, _display->getBar(bar).numPixels());
+        _slots[bar].startMs = nowMs;
+        _slots[bar].active = true;
+    }
+
+    // leaves the bar showing whatever it last showed, for something else to drive
+    void stop(uint8_t bar) { _slots[bar].active = false; }
+
+    bool isPlaying(uint8_t bar) const { return _slots[bar].active; }
+
+    // master brightness, 0..1, applied on top of every animation
+    void setBrightness(float brightness) {
+        _brightnessTween.reset();
+        _brightness = brightness;
+    }
+
+    // hands the master brightness to the tween engine, e.g. a fade in at startup
+    void fadeBrightness(float target, uint32_t durationMs) {
+        auto* tweens = okay::Engine.systems.getSystemChecked<okay::OkayTweenEngine>();
+        _brightnessTween =
+            std::make_shared<okay::OkayTween<float>>(currentBrightness(), target, durationMs);
+        tweens->addTween(_brightnessTween);
+        _brightnessTween->start();
+    }
+
+    float currentBrightness() const {
+        return _brightnessTween ? _brightnessTween->value() : _brightness;
+    }
+
+    void update(uint32_t nowMs) {
+        uint8_t master = masterLevel();
+        for (size_t bar = 0; bar < NUM_BARS; bar++) {
+            draw(static_cast<uint8_t>(bar), master, nowMs);
+        }
+    }
+
+    // brings a single bar up to date, e.g. one just played that shouldn't wait for the next
+    // update(). returns true when the bar was redrawn
+    bool updateBar(uint8_t bar, uint32_t nowMs) { return draw(bar, masterLevel(), nowMs); }
+
+   private:
+    struct Slot {
+        std::vector<platform::Color> table;  // frames * numPixels
+        uint32_t frames = 1;
+        uint32_t stepMs = STEP_MS;
+        uint32_t startMs = 0;
+        uint32_t lastFrame = UINT32_MAX;
+        uint8_t lastMaster = 0;
+        uint8_t numPixels = 0;
+        bool active = false;
+    };
+
+    std::array<Slot, NUM_BARS> _slots{};
+    NeopixelManager* _display = nullptr;
+    float _brightness = 1.0f;
+    std::shared_ptr<okay::OkayTween<float>> _brightnessTween;
+
+    uint8_t masterLevel() const {
+        float brightness = glm::clamp(currentBrightness(), 0.0f, 1.0f);
+        return static_cast<uint8_t>(brightness * 255.0f + 0.5f);
+    }
+
+    bool draw(uint8_t bar, uint8_t master, uint32_t nowMs) {
+        Slot& slot = _slots[bar];
+        if (!slot.active) {
+            return false;
+        }
+
+        uint32_t frame = ((nowMs - slot.startMs) / slot.stepMs) % slot.frames;
+        if (frame == slot.lastFrame && master == slot.lastMaster) {
+            return false;
+        }
+        slot.lastFrame = frame;
+        slot.lastMaster = master;
+
+        VirtualizedNeobar& target = _display->getBar(bar);
+        const platform::Color* colors = slot.table.data() + frame * slot.numPixels;
+        for (uint8_t k = 0; k < slot.numPixels; k++) {
+            platform::Color color = colors[k];
+            uint8_t alpha = platform::mulDiv255(color.a(), master);
+            target.setColor(k, platform::Color{(color.packed & 0x00FFFFFFu) |
+                                               static_cast<uint32_t>(alpha) << 24});
+        }
+        return true;
+    }
+
+    static glm::vec4 gradientAt(const Animation& animation, float t) {
+        if (t < 0.5f) {
+            return glm::mix(animation.stops[0], animation.stops[1], t * 2.0f);
+        }
+        return glm::mix(animation.stops[1], animation.stops[2], (t - 0.5f) * 2.0f);
+    }
+
+    static void compile(Slot& slot, const Animation& animation, uint8_t numPixels) {
+        uint32_t frames = 1;
+        uint32_t stepMs = STEP_MS;
+        if (animation.kind != Animation::Kind::GRADIENT) {
+            stepMs = std::max(STEP_MS, (animation.periodMs + MAX_FRAMES - 1) / MAX_FRAMES);
+            frames = std::clamp<uint32_t>(animation.periodMs / stepMs, 1, MAX_FRAMES);
+        }
+
+        slot.frames = frames;
+        slot.stepMs = stepMs;
+        slot.numPixels = numPixels;
+        slot.lastFrame = UINT32_MAX;
+        slot.table.assign(static_cast<size_t>(frames) * numPixels, platform::Color{});
+
+        for (uint32_t f = 0; f < frames; f++) {
+            float phase = static_cast<float>(f) / static_cast<float>(frames);
+            for (uint8_t k = 0; k < numPixels; k++) {
+                glm::vec4 color = gradientAt(animation, static_cast<float>(k) / numPixels);
+
+                switch (animation.kind) {
+                    case Animation::Kind::GRADIENT:
+                        break;
+                    case Animation::Kind::PULSE:
+                        color.a *= (std::sin(phase * 2.0f * static_cast<float>(M_PI)) + 1.0f) /
+                                   2.0f;
+                        break;
+                    case Animation::Kind::CHASE:
+                        if (static_cast<uint8_t>(phase * numPixels) != k) {
+                            color.a = 0.0f;
+                        }
+                        break;
+                    case Animation::Kind::BLINK:
+                        if (phase * 100.0f >= animation.dutyPercent) {
+                            color.a = 0.0f;
+                        }
+                        break;
+                }
+
+                slot.table[f * numPixels + k] = platform::Color::fromVec4(color);
+            }
+        }
+    }
+};
+
+}  // namespace dash
+
+#endif  // __ANIMATION_HPP__
@@ -0,0 +1,182 @@
+#ifndef __LED_BINDINGS_HPP__
+#define __LED_BINDINGS_HPP__
+
+#include <io/animation.hpp>
+#include <io/lights.hpp>
+#include <platform/color.hpp>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+
+namespace dash {
+
+// Binds a bar to a decoded signal.
+//
+// BAR_GRAPH lights pixels left to right as the value goes from min to max, each lit pixel takes
+// its color from the ramp. A pixel turns on once the value reaches its threshold and only turns
+// off again once the value drops hysteresis below it, so a signal sitting on a threshold doesn't
+// flicker.
+//
+// FLAG blinks the whole bar in ramp[0] while the value is above 0.5, dark otherwise.
+struct LedBinding {
+    enum class Mode : uint8_t {
+        BAR_GRAPH,
+        FLAG
+    };
+
+    uint8_t bar;
+    Mode mode;
+    float (*read)();
+    float min = 0.0f;
+    float max = 1.0f;
+    float hysteresis = 0.0f;
+    std::array<glm::vec4, 3> ramp{};  // low -> high
+    uint32_t blinkPeriodMs = 500;
+};
+
+// Evaluates a table of bindings. Bound bars are taken away from the animation engine, and a
+// binding only recomputes when its signal actually changed.
+class LedBindings {
+   public:
+    static constexpr size_t MAX_BINDINGS = 5;
+
+    void attach(std::span<const LedBinding> table,
+                NeopixelManager& display,
+                AnimationEngine& animations) {
+        _display = &display;
+        _animations = &animations;
+        _count = 0;
+
+        for (const LedBinding& binding : table) {
+            if (_count == MAX_BINDINGS) {
+                okay::Engine.logger.error("Too many LED bindings, ignoring bar {}", binding.bar);
+                continue;
+            }
+
+            State& state = _states[_count++];
+            state = State{};
+            state.binding = binding;
+            state.numPixels = display.getBar(binding.bar).numPixels();
+
+            // thresholds and colors are fixed, so they're worked out once here
+            for (uint8_t k = 0; k < state.numPixels; k++) {
+                float t = static_cast<float>(k) / static_cast<float>(state.numPixels);
+                state.thresholds[k] = binding.min + t * (binding.max - binding.min);
+
+                glm::vec4 color =
+                    t < 0.5f ? glm::mix(binding.ramp[0], binding.ramp[1], t * 2.0f)
+                             : glm::mix(binding.ramp[1], binding.ramp[2], (t - 0.5f) * 2.0f);
+                state.colors[k] = platform::Color::fromVec4(color);
+            }
+
+            animations.stop(binding.bar);
+            clearBar(display.getBar(binding.bar), state.numPixels);
+        }
+    }
+
+    // reads every bound signal. Call holding the bus mutex; the bars are worked out from these
+    // readings by evaluate() once it's dropped
+    void sample() {
+        for (size_t i = 0; i < _count; i++) {
+            _states[i].sampled = _states[i].binding.read();
+        }
+    }
+
+    // returns true when a bar changed and should be pushed out
+    bool evaluate(uint32_t nowMs) {
+        bool changed = false;
+
+        for (size_t i = 0; i < _count; i++) {
+            State& state = _states[i];
+            float value = state.sampled;
+            if (value == state.lastValue) continue;
+            state.lastValue = value;
+
+            VirtualizedNeobar& bar = _display->getBar(state.binding.bar);
+
+            switch (state.binding.mode) {
+                case LedBinding::Mode::BAR_GRAPH:
+                    changed |= updateBarGraph(state, bar, value);
+                    break;
+                case LedBinding::Mode::FLAG:
+                    changed |= updateFlag(state, bar, value, nowMs);
+                    break;
+            }
+        }
+
+        return changed;
+    }
+
+   private:
+    struct State {
+        LedBinding binding{};
+        std::array<float, MAX_BAR_PIXELS> thresholds{};
+        std::array<platform::Color, MAX_BAR_PIXELS> colors{};
+        float sampled = NAN;
+        float lastValue = NAN;
+        uint8_t numPixels = 0;
+        uint8_t lit = 0;
+        bool active = false;
+    };
+
+    std::array<State, MAX_BINDINGS> _states{};
+    size_t _count = 0;
+    NeopixelManager* _display = nullptr;
+    AnimationEngine* _animations = nullptr;
+
+    static void clearBar(VirtualizedNeobar& bar, uint8_t numPixels) {
+        for (uint8_t k = 0; k < numPixels; k++) {
+            bar.setColor(k, platform::Color{});
+        }
+    }
+
+    static bool updateBarGraph(State& state, VirtualizedNeobar& bar, float value) {
+        uint8_t lit = state.lit;
+        while (lit < state.numPixels && value >= state.thresholds[lit]) {
+            lit++;
+        }
+        while (lit > 0 && value < state.thresholds[lit - 1] - state.binding.hysteresis) {
+            lit--;
+        }
+
+        if (lit == state.lit) {
+            return false;
+        }
+        state.lit = lit;
+
+        for (uint8_t k = 0; k < state.numPixels; k++) {
+            bar.setColor(k, k < lit ? state.colors[k] : platform::Color{});
+        }
+        return true;
+    }
+
+    bool updateFlag(State& state, VirtualizedNeobar& bar, float value, uint32_t nowMs) {
+        bool active = value > 0.5f;
+        if (active == state.active) {
+            return false;
+        }
+        state.active = active;
+
+        // the blinking itself is time driven, so it's handed to the animation engine
+        if (active) {
+            Animation blink{.kind = Animation::Kind::BLINK,
+                            .stops = {state.binding.ramp[0],
+                                      state.binding.ramp[0],
+                                      state.binding.ramp[0]},
+                            .periodMs = state.binding.blinkPeriodMs};
+            _animations->play(state.binding.bar, blink, nowMs);
+            _animations->updateBar(state.binding.bar, nowMs);
+        } else {
+            _animations->stop(state.binding.bar);
+            clearBar(bar, state.numPixels);
+        }
+        return true;
+    }
+};
+
+}  // namespace dash
+
+#endif  // __LED_BINDINGS_HPP__
@@ -3,64 +3,77 @@
 
 #include <platform/platform.hpp>
 #include <glm/glm.hpp>
-#include <glm/gtc/epsilon.hpp>
 #include <okay/core/okay.hpp>
+#include <perf/clock.hpp>
+#include <perf/trace.hpp>
 #include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <span>
 #include <cstdint>
-#include <vector>
 #include "okay/core/system/okay_system.hpp"
 
 namespace dash {
 
+// bars are at most 8 pixels, so their state lives inline rather than on the heap
+static constexpr uint8_t MAX_BAR_PIXELS = 8;
+
 struct VirtualizedNeobar {
    public:
+    using Mapping = std::array<uint8_t, MAX_BAR_PIXELS>;
+
     VirtualizedNeobar() = default;
 
-    VirtualizedNeobar(platform::NeopixelStrip* strip,
-                      uint8_t numPixels,
-                      std::vector<uint8_t> mapping)
-        : _strip(strip), _mapping(mapping), _numPixels(numPixels), _dirty(true) {
-        for (int i = 0; i < numPixels; i++) {
-            _currentColors.push_back(glm::vec4(0.0f, 0.0f, 0.0f, 0.0f));
-        }
+    VirtualizedNeobar(platform::NeopixelStrip* strip, uint8_t numPixels, const Mapping& mapping)
+        : _mapping(mapping),
+          _strip(strip),
+          _numPixels(numPixels),
+          _dirtyMask(static_cast<uint8_t>((1u << numPixels) - 1)) {
+        _currentColors.fill(platform::Color{});
     }
 
-    void setColor(uint8_t virtIdx, glm::vec4 color) {
-        // get the existing color and see if they are diffent enough
-        float ep = 0.001f;
-        if (glm::epsilonEqual(_currentColors[virtIdx].x, color.x, ep) &&
-            glm::epsilonEqual(_currentColors[virtIdx].y, color.y, ep) &&
-            glm::epsilonEqual(_currentColors[virtIdx].z, color.z, ep) &&
-            glm::epsilonEqual(_currentColors[virtIdx].w, color.w, ep)) {
-            // okay::Engine.logger.debug("Color is the same");
+    void setColor(uint8_t virtIdx, platform::Color color) {
+        if (_currentColors[virtIdx] == color) {
             return;
         }
         _currentColors[virtIdx] = color;
-        _dirty = true;
+        _dirtyMask |= static_cast<uint8_t>(1u << virtIdx);
+    }
+
+    void setColor(uint8_t virtIdx, const glm::vec4& color) {
+        setColor(virtIdx, platform::Color::fromVec4(color));
     }
 
     uint8_t numPixels() const { return _numPixels; }
-    const std::vector<glm::vec4>& currentColors() const { return _currentColors; }
+    const std::array<platform::Color, MAX_BAR_PIXELS>& currentColors() const {
+        return _currentColors;
+    }
     uint8_t toHardwareIndex(uint8_t virtIdx) const { return _mapping[virtIdx]; }
     platform::NeopixelStrip* strip() const { return _strip; }
-    bool isDirty() const { return _dirty; }
-    void clearDirty() { _dirty = false; }
+    bool isDirty() const { return _dirtyMask != 0; }
+    bool isPixelDirty(uint8_t virtIdx) const { return (_dirtyMask >> virtIdx) & 1u; }
+    void clearDirty() { _dirtyMask = 0; }
 
    private:
-    std::vector<uint8_t> _mapping;  // idx -> hwIdx
-    std::vector<glm::vec4> _currentColors;
-    platform::NeopixelStrip* _strip;
-    uint8_t _numPixels;
-    bool _dirty{true};
+    Mapping _mapping{};  // idx -> hwIdx
+    std::array<platform::Color, MAX_BAR_PIXELS> _currentColors{};
+    platform::NeopixelStrip* _strip = nullptr;
+    uint8_t _numPixels = 0;
+    uint8_t _dirtyMask = 0;  // one bit per pixel that changed since the last updateDisplay
 };
 
 class NeopixelManager : public okay::OkaySystem<okay::OkaySystemScope::GAME> {
    public:
+    // leds on each physical strip: left, top, right
+    static constexpr uint8_t MAX_STRIP_LEDS = 16;
+    static constexpr std::array<uint8_t, 3> STRIP_LEDS = {16, 7, 16};
+    static constexpr size_t TOTAL_LEDS = STRIP_LEDS[0] + STRIP_LEDS[1] + STRIP_LEDS[2];
+
     void initialize() {
         // create the strips
-        _strips[0].init(19, 16);  // left
-        _strips[1].init(13, 7);   // top
-        _strips[2].init(18, 16);  // right
+        _strips[0].init(19, STRIP_LEDS[0]);  // left
+        _strips[1].init(13, STRIP_LEDS[1]);  // top
+        _strips[2].init(18, STRIP_LEDS[2]);  // right
 
         // create the bars
         for (int i = 0; i < 5; i++) {
@@ -69,7 +82,7 @@ class NeopixelManager : public okay::OkaySystem<okay::OkaySystemScope::GAME> {
         }
 
         // set all the bars to black
-        glm::vec4 black = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
+        platform::Color black{};
         for (int i = 0; i < 5; i++) {
             for (int j = 0; j < _bars[i].numPixels(); j++) {
                 _bars[i].setColor(j, black);
@@ -85,7 +98,7 @@ class NeopixelManager : public okay::OkaySystem<okay::OkaySystemScope::GAME> {
 
     void shutdown() {
         // make all the colors black
-        glm::vec4 black = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
+        platform::Color black{};
         for (int i = 0; i < 5; i++) {
             for (int j = 0; j < _bars[i].numPixels(); j++) {
                 _bars[i].setColor(j, black);
@@ -101,30 +114,73 @@ class NeopixelManager : public okay::OkaySystem<okay::OkaySystemScope::GAME> {
     }
 
     void updateDisplay() {
-        for (int i = 0; i < 3; i++) {
-            // grab the relevant bars, and set the color on the strip
-            _strips[i].show();
-            for (int j = 0; j < 5; j++) {
-                if (!_bars[j].isDirty()) continue;
+        uint64_t startNs = perf::monotonicNs();
+
+        // gather the changed bars into their strips' pixel order, then encode each changed strip
+        // in one batch
+        std::array<bool, 3> stripDirty{};
+        for (int j = 0; j < 5; j++) {
+            if (!_bars[j].isDirty()) continue;
+
+            uint8_t hw = getHWIndexForBar(j);
+            for (int k = 0; k < _bars[j].numPixels(); k++) {
+                if (!_bars[j].isPixelDirty(k)) continue;
+                _stripPixels[hw][_bars[j].toHardwareIndex(k)] = _bars[j].currentColors()[k];
+            }
 
-                if (i != getHWIndexForBar(j)) continue;
+            stripDirty[hw] = true;
+            _bars[j].clearDirty();
+        }
 
-                for (int k = 0; k < _bars[j].numPixels(); k++) {
-                    _strips[i].setColor(
-                        _bars[j].toHardwareIndex(k), 
-                        _bars[j].currentColors()[k]);
-                }
+        for (int i = 0; i < 3; i++) {
+            if (!stripDirty[i]) continue;
+            _strips[i].setPixels(std::span<const platform::Color>(_stripPixels[i].data(),
+                                                                  STRIP_LEDS[i]));
+        }
 
-                _bars[j].clearDirty();
-            }
+        // strips that didn't change skip their render
+        platform::NeopixelStrip::showAll(_strips);
 
-            _strips[i].show();
-        }
+        recordOutputTime(perf::monotonicNs() - startNs);
     }
 
    private:
+    static constexpr uint64_t OUTPUT_STATS_PERIOD_NS = 5'000'000'000ULL;
+
     std::array<VirtualizedNeobar, 5> _bars;
     std::array<platform::NeopixelStrip, 3> _strips;
+    std::array<std::array<platform::Color, MAX_STRIP_LEDS>, 3> _stripPixels{};
+
+    // main-thread time spent in updateDisplay, logged every 5 seconds
+    uint64_t _outputWindowStartNs = 0;
+    uint64_t _outputTotalNs = 0;
+    uint64_t _outputMaxNs = 0;
+    uint32_t _outputFrames = 0;
+
+    void recordOutputTime(uint64_t elapsedNs) {
+        perf::trace::counter("led_output_us", static_cast<int64_t>(elapsedNs / 1000));
+
+        _outputTotalNs += elapsedNs;
+        _outputMaxNs = std::max(_outputMaxNs, elapsedNs);
+        _outputFrames++;
+
+        uint64_t now = perf::monotonicNs();
+        if (_outputWindowStartNs == 0) {
+            _outputWindowStartNs = now;
+        }
+        if (now - _outputWindowStartNs < OUTPUT_STATS_PERIOD_NS) {
+            return;
+        }
+
+        okay::Engine.logger.debug("leds: {:.1f}us avg, {:.1f}us max over {} frames",
+                                  static_cast<double>(_outputTotalNs) / _outputFrames / 1000.0,
+                                  static_cast<double>(_outputMaxNs) / 1000.0,
+                                  _outputFrames);
+        _outputWindowStartNs = now;
+        _outputTotalNs = 0;
+        _outputMaxNs = 0;
+        _outputFrames = 0;
+    }
 
     uint8_t numPixelsForBar(uint8_t bar) {
         if (bar == 2) {
@@ -150,8 +206,8 @@ class NeopixelManager : public okay::OkaySystem<okay::OkaySystemScope::GAME> {
     }
 
     // master map
-    std::vector<uint8_t> mappingAtBar(uint8_t bar) {
-        static const std::vector<int> MASTER_MAP = {
+    VirtualizedNeobar::Mapping mappingAtBar(uint8_t bar) {
+        static constexpr uint8_t MASTER_MAP[] = {
             15, 14, 13, 12, 11, 10, 9, 8,  // bar 0
             7,  6,  5,  4,  3,  2,  1, 0,  // bar 1
             0,  1,  2,  3,  4,  5,  6,     // bar 2
@@ -159,7 +215,7 @@ class NeopixelManager : public okay::OkaySystem<okay::OkaySystemScope::GAME> {
             15, 14, 13, 12, 11, 10, 9, 8,  // bar 4
         };
 
-        std::vector<uint8_t> barMap;
+        VirtualizedNeobar::Mapping barMap{};
         uint8_t num = numPixelsForBar(bar);
 
         // find starting point
@@ -170,8 +226,7 @@ class NeopixelManager : public okay::OkaySystem<okay::OkaySystemScope::GAME> {
 
         for (int i = 0; i < num; i++)  // create the actual bars
         {
-            int hwIdx = MASTER_MAP[offset + i];
-            barMap.push_back((uint8_t)hwIdx);  // some funny mapping code
+            barMap[i] = MASTER_MAP[offset + i];  // some funny mapping code
         }
 
         return barMap;
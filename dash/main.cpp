@@ -12,13 +12,34 @@
 #include <nfr_can/CAN_interface.hpp>
 #include <nfr_can/virtual_timer.hpp>
 #include "platform/platform.hpp"
+#include "platform/pixel_encode.hpp"
+#include "platform/ws2812_spi.hpp"
+#include <io/animation.hpp>
+#include <io/led_bindings.hpp>
 #include <io/lights.hpp>
+#include <perf/alloc_tracker.hpp>
+#include <perf/bench.hpp>
+#include <perf/clock.hpp>
+#include <perf/latency_probe.hpp>
+#include <perf/startup_profiler.hpp>
+#include <perf/trace.hpp>
+#include <perf/workload_policy.hpp>
 
 #include "can/can_dbc.hpp"
+#include "can/derived_dbc.hpp"
+#include "can/pack_stats.hpp"
+#include "can/can_link.hpp"
+#include "can/can_replay.hpp"
+#include "can/can_tap.hpp"
 
+#include <algorithm>
+#include <array>
 #include <csignal>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
 #include <string>
-#include <sstream>
+#include <mutex>
 #include <math.h>
 #include "glm/ext/vector_float4.hpp"
 
@@ -27,6 +48,27 @@ static void __gameUpdate();
 static void __gameShutdown();
 static void __motorStatusRecv();
 static void __exitSignal(int sig);
+static void __drawTerminal();
+static void __snapshotSignalTable();
+static void __formatSignalTable();
+static void __collectPrintedSignals();
+static int __envInt(const char* name, int fallback);
+static dash::platform::RealtimeConfig __realtimeConfig();
+static void __benchPixelEncode();
+static void __benchNeopixelUpdate();
+static void __benchWs2812SpiEncode();
+static void __benchInputDispatch();
+static void __benchPackStats();
+static void __benchAllocReplay();
+
+static constexpr dash::perf::bench::Case BENCH_CASES[] = {
+    {"pixel_encode", __benchPixelEncode},
+    {"neopixel_update", __benchNeopixelUpdate},
+    {"ws2812_spi_encode", __benchWs2812SpiEncode},
+    {"input_dispatch", __benchInputDispatch},
+    {"pack_stats", __benchPackStats},
+    {"alloc_replay", __benchAllocReplay},
+};
 
 bool re_pressed = false;
 void re_button_callback(){
@@ -37,11 +79,8 @@ void re_up_cb(){
 }
 
 int16_t encoder_counter = 0;
-void re_right_cb(){
-    encoder_counter++;;
-}
-void re_left_cb(){
-    encoder_counter--;
+void re_delta_cb(int delta){
+    encoder_counter += delta;
 }
 
 bool down_pressed = false;
@@ -82,13 +121,21 @@ static std::vector<ICAN_Message*> g_toPrint = {
     &dbc::rearInverterFaultStatus::message,
     &dbc::rearInverterPowerDraw::message,
     &dbc::rearInverterMotorStatus::message,
-    &dbc::rearInverterTempStatus::message
+    &dbc::rearInverterTempStatus::message,
+    &dbc::derived::packPower::message,
+    &dbc::derived::inverterEnergy::message,
+    &dbc::derived::inverterNetEnergy::message,
+    &dbc::derived::torqueSplit::message,
+    &dbc::derived::brakeBias::message
 };
 // clang-format on
 
 // heartbeat message
 inline uint64_t g_heartbeatCount = 0;
 inline VirtualTimerGroup g_timerGroup;
+// TX messages send through the CAN driver, so their timers only run once the link hands the bus
+// to the main loop; until then the link thread may be initialising or resetting the controller
+inline VirtualTimerGroup g_canTimerGroup;
 inline dash::platform::Clock g_canClock;
 
 TX_can_msg_config g_heartbeat_conf = {.bus = dbc::driveBus,
@@ -96,13 +143,84 @@ TX_can_msg_config g_heartbeat_conf = {.bus = dbc::driveBus,
                                       .extended = false,
                                       .length = 8,
                                       .period = 1000,
-                                      .timerGroup = g_timerGroup};
+                                      .timerGroup = g_canTimerGroup};
 
 inline CAN_Signal_UINT64 g_heartbeatSignal = MakeSignalExp(uint64_t, 0, 64, 1.0, 0.0);
 inline TX_CAN_Message(1) g_heartbeatMessage{g_heartbeat_conf, g_heartbeatSignal};
 
+// last value of the latency probe's signal
+static int16_t g_probeRpm = 0;
+
+// sheds non-critical work based on the ECU drive state
+static dash::perf::WorkloadGovernor g_workload;
+static CANLink g_canLink{dbc::driveBus, BaudRate::kBaud500K};
+static dash::AnimationEngine g_animations;
+static dash::LedBindings g_ledBindings;
+static dash::DerivedSignals g_derivedSignals;
+static dash::PackStats g_packStats;
+
+// signals shown on the terminal, resolved once at init. value holds the last reading, by type
+struct PrintedSignal {
+    const char* name;
+    ICAN_Signal* signal;
+    SignalType type;
+    union {
+        int64_t i;
+        uint64_t u;
+        double f;
+    } value;
+};
+static std::vector<PrintedSignal> g_printedSignals;
+
+// fixed buffer the terminal frame is formatted into, so a redraw doesn't touch the heap
+class FrameBuffer {
+   public:
+    void clear() { _size = 0; }
+
+    void append(const char* text) { printf("%s", text); }
+
+    int printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        int written = std::vsnprintf(_data.data() + _size, _data.size() - _size, format, args);
+        va_end(args);
+
+        if (written < 0) return 0;
+        _size = std::min(_size + static_cast<size_t>(written), _data.size() - 1);
+        return written;
+    }
+
+    void pad(int count) {
+        for (; count > 0 && _size < _data.size() - 1; count--) {
+            _data[_size++] = ' ';
+        }
+    }
+
+    const char* data() const { return _data.data(); }
+    size_t size() const { return _size; }
+
+   private:
+    std::array<char, 16 * 1024> _data{};
+    size_t _size = 0;
+};
+static FrameBuffer g_frame;
+
 
 int main() {
+    dash::perf::startup::mark("main");
+
+    if (dash::perf::bench::runFromEnvironment(BENCH_CASES)) {
+        return dash::perf::bench::failed() ? 1 : 0;
+    }
+
+    // lock memory before anything else allocates or spawns threads. The main thread stays under
+    // the normal scheduler, only the CAN and input threads are started real-time
+    dash::platform::configureRealtime(__realtimeConfig());
+    dash::platform::beginHardwareInit();
+    dash::perf::trace::configureFromEnvironment();
+    dash::perf::trace::setThreadName("main");
+    dash::perf::latency::configureFromEnvironment();
+
     okay::SurfaceConfig surfaceConfig;
     okay::Surface surface(surfaceConfig);
 
@@ -120,6 +238,7 @@ int main() {
     // attach an interrupt to exit the program on ctrl c
     std::signal(SIGINT, __exitSignal);
 
+    dash::perf::startup::mark("engine start");
     okay::OkayGame::create()
         .addSystems(std::move(levelManager),
                     std::make_unique<okay::OkayRenderer>(std::move(rendererSettings)),
@@ -135,57 +254,195 @@ int main() {
     return 0;
 }
 
-static void __updateLights() {
-    dash::NeopixelManager* display = okay::Engine.systems.getSystemChecked<dash::NeopixelManager>();
+// starts a latency sample whenever the probe signal changes
+static void __probeDecoded(uint64_t tickStartNs) {
+    if (!dash::perf::latency::enabled()) {
+        return;
+    }
+
+    int16_t rpm = dbc::rearInverterMotorStatus::rpm.get();
+    if (rpm == g_probeRpm) {
+        return;
+    }
 
+    g_probeRpm = rpm;
+    dash::perf::latency::beginSample(dbc::rearInverterMotorStatus::message.get_id().id,
+                                     tickStartNs);
+    dash::perf::latency::markDecoded();
+}
+
+// TX timers and RX, run by the link thread or the main loop, holding the bus mutex
+static void __tickBus() {
+    g_canTimerGroup.Tick(g_canClock.monotonicMs());
+    dbc::driveBus.tick_bus();
+}
+
+static uint32_t __nowMs() {
+    return static_cast<uint32_t>(dash::perf::monotonicNs() / 1'000'000);
+}
+
+// reads what the frame takes from the bus once it's been ticked, holding the bus mutex, and
+// returns the drive state. Only signal reads happen here so the CAN thread isn't kept waiting;
+// derived signals are computed here too, as their compute reads the bus directly
+static uint8_t __sampleBus(uint64_t tickStartNs) {
+    __probeDecoded(tickStartNs);
+
+    {
+        DASH_TRACE_SCOPE("derived_signals");
+        g_derivedSignals.evaluate();
+    }
+
+    g_packStats.collect(dash::frameArrivals());
+    // everything that arrived since the last frame has been copied out
+    dash::frameArrivals().clear();
+
+    g_ledBindings.sample();
+    return dbc::ecuDriveStatus::driveState.get();
+}
+
+// works through what __sampleBus read, after the bus mutex is dropped. Bound bars are set here and
+// go out with the rest of the lights stage's single render
+static void __consumeBus(uint8_t driveState) {
+    g_workload.setDriveState(driveState);
+
+    {
+        DASH_TRACE_SCOPE("pack_stats");
+        g_packStats.reduce();
+    }
+
+    g_ledBindings.evaluate(__nowMs());
+}
+
+// shift light range on the rear inverter, in rpm
+static constexpr float SHIFT_LIGHT_MIN_RPM = 2000.0f;
+static constexpr float SHIFT_LIGHT_MAX_RPM = 5500.0f;
+
+static float __readRpm() {
+    return static_cast<float>(dbc::rearInverterMotorStatus::rpm.get());
+}
+
+static float __readSoc() {
+    return dbc::bmsStatus::bmsSoc.get();
+}
+
+static float __readFaults() {
+    bool fault = dbc::bmsFaults::internalfaultSummary.get() || dbc::bmsFaults::externalFault.get() ||
+                 dbc::ecuImplausibility::implausibilityPresent.get();
+    return fault ? 1.0f : 0.0f;
+}
+
+static void __bindLights(dash::NeopixelManager& display) {
+    const glm::vec4 red = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+    const glm::vec4 yellow = glm::vec4(1.0f, 0.8f, 0.0f, 1.0f);
+    const glm::vec4 green = glm::vec4(0.0f, 1.0f, 0.0f, 1.0f);
+
+    const dash::LedBinding bindings[] = {
+        {.bar = 0,
+         .mode = dash::LedBinding::Mode::BAR_GRAPH,
+         .read = __readSoc,
+         .min = 0.0f,
+         .max = 1.0f,
+         .hysteresis = 0.02f,
+         .ramp = {red, yellow, green}},
+        {.bar = 2,
+         .mode = dash::LedBinding::Mode::BAR_GRAPH,
+         .read = __readRpm,
+         .min = SHIFT_LIGHT_MIN_RPM,
+         .max = SHIFT_LIGHT_MAX_RPM,
+         .hysteresis = 100.0f,
+         .ramp = {green, yellow, red}},
+        {.bar = 4,
+         .mode = dash::LedBinding::Mode::FLAG,
+         .read = __readFaults,
+         .ramp = {red, red, red},
+         .blinkPeriodMs = 250},
+    };
+
+    // the probe pattern owns the top bar while it runs
+    std::span<const dash::LedBinding> table(bindings);
+    if (dash::perf::latency::enabled()) {
+        dash::LedBinding withoutShift[] = {bindings[0], bindings[2]};
+        g_ledBindings.attach(withoutShift, display, g_animations);
+        return;
+    }
+    g_ledBindings.attach(table, display, g_animations);
+}
+
+// fadeIn hands the master brightness to the tween engine, which only exists once the game runs
+static void __startAnimations(bool fadeIn) {
     glm::vec4 red = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
     glm::vec4 green = glm::vec4(0.0f, 1.0f, 0.0f, 1.0f);
     glm::vec4 blue = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
-    glm::vec4 white = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
     glm::vec4 black = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
     glm::vec4 purple = glm::vec4(1.0f, 0.0f, 1.0f, 1.0f);
 
-    // get time since the start of the program in ms
-    std::chrono::time_point<std::chrono::steady_clock> now = std::chrono::steady_clock::now();
-    std::chrono::duration<float, std::milli> ms = now.time_since_epoch();
-    float brightness = (std::sin(ms.count() / 1000.0f) + 1.0f) / 2.0f;
-
-    for (int i = 0; i < 5; i++) {
-        for (int j = 0; j < display->getBar(i).numPixels(); j++) {
-            float t = (float)j / (float)display->getBar(i).numPixels();
-            glm::vec4 a = red;
-            glm::vec4 b = green;
-            glm::vec4 c = blue;
-
-            if (i == 2) {
-                a = purple;
-                b = black;
-                c = purple;
-            }
+    // red -> green -> blue across each bar (purple/black on the top one), breathing once every
+    // 2pi seconds
+    dash::Animation gradient{
+        .kind = dash::Animation::Kind::PULSE, .stops = {red, green, blue}, .periodMs = 6283};
+    dash::Animation top = gradient;
+    top.stops = {purple, black, purple};
 
-            glm::vec4 color = a;
-            // mix between red green and blue with a gradient
-            if (t < 0.5f) {
-                // Map t from [0, 0.5] to [0, 1] for R->G
-                color = glm::mix(a, b, t * 2.0f);
-            } else {
-                // Map t from [0.5, 1] to [0, 1] for G->B
-                color = glm::mix(b, c, (t - 0.5f) * 2.0f);
+    uint32_t now = __nowMs();
+    for (uint8_t i = 0; i < 5; i++) {
+        if (i == 2) {
+            // the top bar belongs to the probe pattern while it runs
+            if (!dash::perf::latency::enabled()) {
+                g_animations.play(i, top, now);
             }
+            continue;
+        }
+        g_animations.play(i, gradient, now);
+    }
+
+    if (fadeIn) {
+        g_animations.setBrightness(0.0f);
+        g_animations.fadeBrightness(1.0f, 1000);
+    }
+}
+
+static void __updateLights(uint64_t frameStartNs) {
+    dash::NeopixelManager* display = okay::Engine.systems.getSystemChecked<dash::NeopixelManager>();
+
+    if (g_workload.shouldRun(dash::perf::WorkStage::ANIMATIONS, frameStartNs)) {
+        g_animations.update(__nowMs());
+    }
 
-            color.a = brightness;
-            display->getBar(i).setColor(j, color);
+    if (dash::perf::latency::enabled()) {
+        // probe test mode: the low bits of the rear inverter rpm, in binary on the top bar, so
+        // that every change of the signal changes what the LEDs show
+        constexpr dash::platform::Color PROBE_ON = dash::platform::Color::rgba(255, 255, 255);
+        constexpr dash::platform::Color PROBE_OFF = dash::platform::Color::rgba(0, 0, 0);
+
+        dash::VirtualizedNeobar& shiftLight = display->getBar(2);
+        for (int j = 0; j < shiftLight.numPixels(); j++) {
+            shiftLight.setColor(j, ((g_probeRpm >> j) & 1) ? PROBE_ON : PROBE_OFF);
         }
+        dash::perf::latency::markLights();
     }
 
     display->updateDisplay();
 }
 
+static void __collectPrintedSignals() {
+    for (ICAN_Message* msg : g_toPrint) {
+        for (std::uint8_t sigNum = 0; sigNum < msg->get_num_signals(); sigNum++) {
+            auto sigId = std::pair{msg->get_id().id, sigNum};
+
+            const char* name = dbc::signalName(sigId);
+            if (name == nullptr)
+                name = "(unknown)";
+
+            ICAN_Signal* signal = msg->get_signal(sigNum);
+            g_printedSignals.push_back({name, signal, signal->getSignalType(), {}});
+        }
+    }
+}
+
 static void __interruptInitialize(){
     reButton.onDown(re_button_callback);
     reButton.onUp(re_up_cb);
-    rotaryEncoder.onLeft(re_left_cb);
-    rotaryEncoder.onRight(re_right_cb);
+    rotaryEncoder.onDelta(re_delta_cb);
 
     downButton.onDown(down_down_cb);
     downButton.onUp(down_up_cb);
@@ -199,22 +456,33 @@ static void __interruptInitialize(){
 
 static void __gameInitialize() {
     std::cout << "Game initialized." << std::endl;
+    dash::perf::startup::mark("game initialize");
     g_timerGroup.AddTimer(1000, []() { g_heartbeatCount++; });
     g_timerGroup.AddTimer(20, []() { __flushScreen(); });
     
     dash::platform::configureCANDriver(dbc::driveBus);
+    dash::perf::startup::mark("can driver configured");
 
-    // Additional game initialization logic
-    BaudRate baud500k = BaudRate::kBaud500K;
-    if (!dbc::driveBus.init(baud500k)) {
-        okay::Engine.logger.error("Failed to initialize CAN bus");
-
-        while (true) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        }
+    // the bus comes up in the background, everything else runs in "no CAN" mode until then. Where
+    // the driver allows it the link thread keeps ticking it too, otherwise the main loop does
+    if (dash::platform::tickCANOffMainThread()) {
+        g_canLink.tickOnThread(__tickBus);
     }
+    g_workload.setBusOnLoop(!g_canLink.ticksOnThread());
+    g_canLink.start();
 
     __interruptInitialize();
+    __collectPrintedSignals();
+    g_derivedSignals.attach(dbc::derived::SIGNALS);
+    g_packStats.attach(dbc::driveBus);
+
+    dash::NeopixelManager* display = okay::Engine.systems.getSystemChecked<dash::NeopixelManager>();
+    g_animations.attach(*display);
+    __startAnimations(true);
+    __bindLights(*display);
+
+    // whatever still allocates after warmup is a regression
+    dash::perf::armSteadyState(120, __envInt("DASH_ALLOC_ABORT", 0) != 0);
 
     std::ios::sync_with_stdio(false);
     std::cout.tie(nullptr);
@@ -223,7 +491,147 @@ static void __gameInitialize() {
     std::cout.flush();
 }
 
+static void __drawPackStats() {
+    const dash::PackStats::Voltages& voltages = g_packStats.voltages();
+    if (voltages.complete()) {
+        const dash::CellStats& v = voltages.stats();
+        g_frame.printf("\nCells: min %.3fV (#%u) max %.3fV (#%u) mean %.3fV std %.1fmV "
+                       "imbalance %.0fmV\n",
+                       v.min, static_cast<unsigned>(v.argmin),
+                       v.max, static_cast<unsigned>(v.argmax),
+                       v.mean, v.stddev * 1000.0f, v.spread() * 1000.0f);
+    } else {
+        g_frame.printf("\nCells: waiting for voltage frames (%zu/%zu)\n",
+                       voltages.framesSeen(),
+                       voltages.NUM_FRAMES);
+    }
+
+    const dash::PackStats::Temperatures& temperatures = g_packStats.temperatures();
+    if (temperatures.complete()) {
+        const dash::CellStats& t = temperatures.stats();
+        g_frame.printf("Temps: min %.0fC (#%u) max %.0fC (#%u) mean %.1fC std %.1fC\n",
+                       t.min, static_cast<unsigned>(t.argmin),
+                       t.max, static_cast<unsigned>(t.argmax),
+                       t.mean, t.stddev);
+    } else {
+        g_frame.printf("Temps: waiting for temperature frames (%zu/%zu)\n",
+                       temperatures.framesSeen(),
+                       temperatures.NUM_FRAMES);
+    }
+}
+
+template <typename T>
+static T __signalGet(ICAN_Signal* signal) {
+    return static_cast<CAN_Signal<T>*>(signal)->get();
+}
+
+static void __readPrinted(PrintedSignal& printed) {
+    ICAN_Signal* signal = printed.signal;
+    switch (printed.type) {
+        case SignalType::INT8:   printed.value.i = __signalGet<int8_t>(signal); break;
+        case SignalType::INT16:  printed.value.i = __signalGet<int16_t>(signal); break;
+        case SignalType::INT32:  printed.value.i = __signalGet<int32_t>(signal); break;
+        case SignalType::INT64:  printed.value.i = __signalGet<int64_t>(signal); break;
+        case SignalType::UINT8:  printed.value.u = __signalGet<uint8_t>(signal); break;
+        case SignalType::UINT16: printed.value.u = __signalGet<uint16_t>(signal); break;
+        case SignalType::UINT32: printed.value.u = __signalGet<uint32_t>(signal); break;
+        case SignalType::UINT64: printed.value.u = __signalGet<uint64_t>(signal); break;
+        case SignalType::FLOAT:  printed.value.f = __signalGet<float>(signal); break;
+        case SignalType::BOOL:   printed.value.u = __signalGet<bool>(signal); break;
+    }
+}
+
+// formats the last reading straight into the frame, in the same format as to_string() but without
+// the std::string it builds
+static int __printValue(const PrintedSignal& printed) {
+    switch (printed.type) {
+        case SignalType::INT8:
+        case SignalType::INT16:
+        case SignalType::INT32:
+        case SignalType::INT64:
+            return g_frame.printf(
+                "%s: %lld", printed.name, static_cast<long long>(printed.value.i));
+        case SignalType::UINT8:
+        case SignalType::UINT16:
+        case SignalType::UINT32:
+        case SignalType::UINT64:
+        case SignalType::BOOL:
+            return g_frame.printf(
+                "%s: %llu", printed.name, static_cast<unsigned long long>(printed.value.u));
+        case SignalType::FLOAT:
+            return g_frame.printf("%s: %f", printed.name, printed.value.f);
+    }
+    return 0;
+}
+
+// reads every printed signal, holding the bus mutex
+static void __snapshotSignalTable() {
+    for (PrintedSignal& printed : g_printedSignals) {
+        __readPrinted(printed);
+    }
+}
+
+// formats the last snapshot, so it doesn't need the bus mutex
+static void __formatSignalTable() {
+    constexpr size_t COLS = 3;
+    constexpr int COL_WIDTH = 32;
+
+    size_t rows = (g_printedSignals.size() + COLS - 1) / COLS;
+
+    // Print row-wise across columns
+    for (size_t r = 0; r < rows; r++) {
+        for (size_t c = 0; c < COLS; c++) {
+            size_t idx = r + c * rows;
+            if (idx < g_printedSignals.size()) {
+                g_frame.pad(COL_WIDTH - __printValue(g_printedSignals[idx]));
+            }
+        }
+        g_frame.append("\n");
+    }
+}
+
+static void __drawTerminal() {
+    g_frame.clear();
+    g_frame.append("\x1b[H\x1b[J");
+    g_frame.printf("NFR26 Development Dashboard [%s, shed %llu]\n",
+                   dash::perf::driveStateName(g_workload.driveState()),
+                   static_cast<unsigned long long>(
+                       g_workload.shedCount(dash::perf::WorkStage::SIGNAL_TABLE)));
+    if (!g_canLink.isUp()) {
+        g_frame.printf("NO CAN [%s, attempt %u]\n",
+                       canLinkStateName(g_canLink.state()),
+                       static_cast<unsigned>(g_canLink.attempts()));
+    }
+
+    // the values are copied out under the bus mutex and formatted once it's dropped
+    {
+        std::lock_guard<dash::platform::RealtimeMutex> bus(g_canLink.busMutex());
+        __snapshotSignalTable();
+    }
+    __formatSignalTable();
+
+    __drawPackStats();
+
+    g_frame.printf("\nINPUT DEMO:\n");
+    g_frame.printf("Down Button: %s\n", downButton.isDown() ? "held" : "not held");
+    g_frame.printf("Right Button: %s\n", rightButton.isDown() ? "held" : "not held");
+    g_frame.printf("Left Button: %s\n", leftButton.isDown() ? "held" : "not held");
+    g_frame.printf("RE Button: %s\n", reButton.isDown() ? "held" : "not held");
+    g_frame.printf("RE Count Val: %d", encoder_counter);
+
+    // print to stdout, and flush
+    DASH_TRACE_SCOPE("terminal_write");
+    dash::perf::trace::counter("terminal_bytes", static_cast<int64_t>(g_frame.size()));
+    std::cout.write(g_frame.data(), static_cast<std::streamsize>(g_frame.size()));
+    std::cout.flush();
+    dash::perf::latency::markTerminal();
+}
+
 static void __gameShutdown() {
+    g_canLink.stop();
+    dash::perf::trace::dump();
+    g_workload.logCounters();
+
     std::cout << "Game shutdown." << std::endl;
     std::cout << "\x1b[?25h\x1b[?1049l";
     std::cout.flush();
@@ -231,68 +639,472 @@ static void __gameShutdown() {
 }
 
 static void __gameUpdate() {
-    dash::platform::preUpdate();
+    DASH_TRACE_SCOPE("frame");
+    uint64_t frameStartNs = dash::perf::monotonicNs();
+    dash::perf::beginFrame();
 
-    g_timerGroup.Tick(g_canClock.monotonicMs());
-    dbc::driveBus.tick_bus();
-    __updateLights();
+    {
+        dash::perf::AllocScope scope{dash::perf::Stage::PLATFORM};
+        dash::platform::preUpdate();
+    }
 
-    dash::platform::tick();
+    {
+        dash::perf::AllocScope scope{dash::perf::Stage::CAN};
+        g_timerGroup.Tick(g_canClock.monotonicMs());
 
-    std::cout << "\x1b[H\x1b[J";
+        if (g_canLink.isUp()) {
+            uint8_t driveState = 0;
+            {
+                std::lock_guard<dash::platform::RealtimeMutex> bus(g_canLink.busMutex());
+                uint64_t tickStartNs = dash::perf::latency::nowNs();
+                if (!g_canLink.ticksOnThread()) {
+                    DASH_TRACE_SCOPE("tick_bus");
+                    __tickBus();
+                }
+                driveState = __sampleBus(tickStartNs);
+            }
+            __consumeBus(driveState);
+        }
+    }
 
-    std::cout << "NFR26 Development Dashboard\n";
+    {
+        dash::perf::AllocScope scope{dash::perf::Stage::LIGHTS};
+        DASH_TRACE_SCOPE("lights");
+        __updateLights(frameStartNs);
+    }
 
-    // Collect all signal strings
-    std::vector<std::string> lines;
-    for (ICAN_Message* msg : g_toPrint) {
-        for (std::uint8_t sigNum = 0; sigNum < msg->get_num_signals(); sigNum++) {
-            auto sigId = std::pair{msg->get_id().id, sigNum};
+    {
+        dash::perf::AllocScope scope{dash::perf::Stage::PLATFORM};
+        dash::platform::tick();
+    }
 
-            const char* name = "(unknown)";
-            auto it = dbc::meta::signalIdToName.find(sigId);
-            if (it != dbc::meta::signalIdToName.end())
-                name = it->second;
+    if (g_workload.shouldRun(dash::perf::WorkStage::SIGNAL_TABLE, frameStartNs)) {
+        dash::perf::AllocScope scope{dash::perf::Stage::DISPLAY};
+        DASH_TRACE_SCOPE("terminal");
+        __drawTerminal();
+    }
+
+    {
+        dash::perf::AllocScope scope{dash::perf::Stage::INPUT};
+        dash::platform::postUpdate();
+    }
+
+    dash::perf::endFrame();
+    dash::perf::trace::poll();
+    dash::perf::startup::tick();
+
+    if (g_workload.shouldRun(dash::perf::WorkStage::DIAGNOSTICS, frameStartNs)) {
+        dash::perf::latency::tick();
+        dash::platform::tickDiagnostics();
+    }
+
+    DASH_TRACE_SCOPE("throttle");
+    g_workload.throttleLoop(frameStartNs);
+}
 
-            lines.emplace_back(std::string{name} + ": " + msg->get_signal(sigNum)->to_string());
+static int __envInt(const char* name, int fallback) {
+    const char* value = std::getenv(name);
+    return value != nullptr ? std::atoi(value) : fallback;
+}
+
+// DASH_RT=1 enables real-time mode, the rest override the default priorities and cores
+static dash::platform::RealtimeConfig __realtimeConfig() {
+    dash::platform::RealtimeConfig config;
+    config.enabled = __envInt("DASH_RT", 0) != 0;
+    config.canPriority = __envInt("DASH_RT_CAN_PRIO", config.canPriority);
+    config.inputPriority = __envInt("DASH_RT_INPUT_PRIO", config.inputPriority);
+    config.canCpu = __envInt("DASH_RT_CAN_CPU", config.canCpu);
+    config.inputCpu = __envInt("DASH_RT_INPUT_CPU", config.inputCpu);
+    return config;
+}
+
+static void __exitSignal(int sig) {
+    okay::Engine.logger.info("Exit signal received: {}", sig);
+    okay::Engine.shutdown();
+}
+
+// encoding every LED on the car (39 across the three strips), batched vs one pixel at a time
+static void __benchPixelEncode() {
+    constexpr size_t ITERATIONS = 1'000'000;
+    constexpr auto& STRIP_LEDS = dash::NeopixelManager::STRIP_LEDS;
+
+    std::array<dash::platform::Color, dash::NeopixelManager::TOTAL_LEDS> pixels;
+    uint32_t seed = 0x2545F491;
+    for (dash::platform::Color& pixel : pixels) {
+        seed = seed * 1664525u + 1013904223u;
+        pixel.packed = seed;
+    }
+    std::array<uint32_t, dash::NeopixelManager::TOTAL_LEDS> encoded{};
+
+    auto encodeAll = [&](auto encode) {
+        size_t offset = 0;
+        for (size_t leds : STRIP_LEDS) {
+            encode(pixels.data() + offset, encoded.data() + offset, leds);
+            offset += leds;
         }
+        dash::perf::bench::doNotOptimize(encoded.data());
+    };
+
+    dash::perf::bench::measure("encodePixels, 39 leds", ITERATIONS, [&] {
+        encodeAll(dash::platform::encodePixels);
+    });
+    dash::perf::bench::measure("encodePixelsScalar, 39 leds", ITERATIONS, [&] {
+        encodeAll(dash::platform::encodePixelsScalar);
+    });
+
+    // the vector path has to give exactly the scalar words, for the strips as they're laid out
+    // (tails included) and for every color and alpha pair
+    size_t mismatches = 0;
+    std::array<uint32_t, dash::NeopixelManager::TOTAL_LEDS> scalar = encoded;
+    encodeAll(dash::platform::encodePixels);
+    for (size_t i = 0; i < encoded.size(); i++) {
+        mismatches += encoded[i] != scalar[i] ? 1 : 0;
     }
 
-    constexpr int COLS = 3;
-    constexpr int COL_WIDTH = 32;
+    std::array<dash::platform::Color, 256> ramp;
+    std::array<uint32_t, 256> vectorWords;
+    std::array<uint32_t, 256> scalarWords;
+    for (uint32_t a = 0; a < 256; a++) {
+        // every channel goes through all 256 values at this alpha
+        for (uint32_t c = 0; c < 256; c++) {
+            ramp[c] = dash::platform::Color::rgba(static_cast<uint8_t>(c),
+                                                  static_cast<uint8_t>(255 - c),
+                                                  static_cast<uint8_t>(c ^ 0x5A),
+                                                  static_cast<uint8_t>(a));
+        }
+        dash::platform::encodePixels(ramp.data(), vectorWords.data(), ramp.size());
+        dash::platform::encodePixelsScalar(ramp.data(), scalarWords.data(), ramp.size());
+        for (size_t c = 0; c < ramp.size(); c++) {
+            mismatches += vectorWords[c] != scalarWords[c] ? 1 : 0;
+        }
+    }
 
-    size_t rows = (lines.size() + COLS - 1) / COLS;
+    okay::Engine.logger.info("bench:   {} words differ from encodePixelsScalar", mismatches);
+    if (mismatches != 0) {
+        dash::perf::bench::fail();
+    }
+}
 
-    std::ostringstream frame;
+// the whole LED output path at 1 kHz, with every pixel of every bar changing each frame
+static void __benchNeopixelUpdate() {
+    constexpr uint32_t FRAMES = 5000;
+    constexpr std::chrono::microseconds PERIOD{1000};
 
-    // Print row-wise across columns
-    for (size_t r = 0; r < rows; r++) {
-        for (size_t c = 0; c < COLS; c++) {
-            size_t idx = r + c * rows;
-            if (idx < lines.size()) {
-                frame << std::left << std::setw(COL_WIDTH) << lines[idx];
+    dash::NeopixelManager display;
+    display.initialize();
+
+    uint64_t cpuTotalNs = 0;
+    uint64_t cpuMaxNs = 0;
+    auto next = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        for (uint8_t bar = 0; bar < 5; bar++) {
+            dash::VirtualizedNeobar& target = display.getBar(bar);
+            for (uint8_t k = 0; k < target.numPixels(); k++) {
+                uint32_t v = frame * 7 + bar * 31 + k * 13;
+                target.setColor(k,
+                                dash::platform::Color::rgba(static_cast<uint8_t>(v),
+                                                            static_cast<uint8_t>(v >> 1),
+                                                            static_cast<uint8_t>(255 - v)));
             }
         }
-        frame << '\n';
+
+        uint64_t cpuStartNs = dash::perf::bench::threadCpuNs();
+        display.updateDisplay();
+        uint64_t cpuNs = dash::perf::bench::threadCpuNs() - cpuStartNs;
+        cpuTotalNs += cpuNs;
+        cpuMaxNs = std::max(cpuMaxNs, cpuNs);
+
+        next += PERIOD;
+        std::this_thread::sleep_until(next);
     }
 
-    std::cout << frame.str();
+    display.shutdown();
+
+    dash::perf::bench::report("updateDisplay cpu, 1kHz", FRAMES, cpuTotalNs);
+    okay::Engine.logger.info("bench:   worst frame {:.1f}us cpu", cpuMaxNs / 1000.0);
+}
 
-    std::string out = "\nINPUT DEMO:\n";
-    out += "Down Button: " + std::string(downButton.isDown() ? "held" : "not held") + "\n";
-    out += "Right Button: " + std::string(rightButton.isDown() ? "held" : "not held") + "\n";
-    out += "Left Button: " + std::string(leftButton.isDown() ? "held" : "not held") + "\n";
-    out += "RE Button: " + std::string(reButton.isDown() ? "held" : "not held") + "\n";
-    out += "RE Count Val: " + std::to_string(encoder_counter);
+// WS2812 SPI bitstreams for all 39 LEDs, at both bit widths
+static void __benchWs2812SpiEncode() {
+    constexpr size_t ITERATIONS = 1'000'000;
+    constexpr auto& STRIP_LEDS = dash::NeopixelManager::STRIP_LEDS;
 
-    // print to stdout, and flush
-    std::cout << out;
-    std::cout.flush();
-    std::cout.flush();
-    dash::platform::postUpdate();
+    std::array<uint32_t, dash::NeopixelManager::TOTAL_LEDS> words;
+    uint32_t seed = 0x2545F491;
+    for (uint32_t& word : words) {
+        seed = seed * 1664525u + 1013904223u;
+        word = seed;
+    }
+
+    auto run = [&](auto encoding, const char* label) {
+        using Encoding = decltype(encoding);
+        std::array<uint8_t, Encoding::bufferSize(dash::NeopixelManager::MAX_STRIP_LEDS)> buffer{};
+
+        dash::perf::bench::measure(label, ITERATIONS, [&] {
+            size_t offset = 0;
+            for (size_t leds : STRIP_LEDS) {
+                Encoding::encode(words.data() + offset, leds, buffer.data());
+                dash::perf::bench::doNotOptimize(buffer.data());
+                offset += leds;
+            }
+        });
+    };
+
+    run(dash::platform::ws2812::Encoding<3>{}, "3 bit encode, 39 leds");
+    run(dash::platform::ws2812::Encoding<4>{}, "4 bit encode, 39 leds");
 }
 
-static void __exitSignal(int sig) {
-    okay::Engine.logger.info("Exit signal received: {}", sig);
-    okay::Engine.shutdown();
+// InputManager with an encoder spun at 2 kHz of edges and a button tapped every frame, at 60 fps.
+// The edges are pushed straight into InputManager, so this runs without hardware, and every frame
+// checks the callbacks and the THIS_FRAME states against what was injected.
+static void __benchInputDispatch() {
+    using dash::platform::InputEvent;
+    using dash::platform::InputManager;
+
+    constexpr uint8_t BUTTON_PIN = 26;
+    constexpr uint8_t ENCODER_A = 24;
+    constexpr uint8_t ENCODER_B = 25;
+    constexpr uint16_t ENCODER_ID = (ENCODER_A << 8) | ENCODER_B;
+    constexpr uint64_t EDGE_NS = 500'000;
+    constexpr uint64_t FRAME_NS = 16'666'667;
+    constexpr uint32_t FRAMES = 10'000;
+
+    InputManager& input = InputManager::instance();
+    input.registerButton(BUTTON_PIN);
+    input.registerEncoder(ENCODER_ID, ENCODER_A, ENCODER_B);
+    // one step per detent, so the steps can be checked against the edges
+    input.setEncoderAcceleration(ENCODER_ID, {.maxStepsPerDetent = 1});
+
+    uint32_t downs = 0;
+    uint32_t ups = 0;
+    int64_t steps = 0;
+    input.attachDownCallback(BUTTON_PIN, [&] { downs++; });
+    input.attachUpCallback(BUTTON_PIN, [&] { ups++; });
+    input.attachDeltaCallback(ENCODER_ID, [&](int delta) { steps += delta; });
+
+    bool levelA = false;
+    bool levelB = false;
+    uint64_t edges = 0;
+    uint64_t nextEdgeNs = 0;
+    uint64_t sequence = 0;
+    uint32_t badFrames = 0;
+    uint64_t cpuTotalNs = 0;
+    uint64_t cpuMaxNs = 0;
+
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        uint64_t frameStartNs = static_cast<uint64_t>(frame) * FRAME_NS;
+        uint64_t frameEndNs = frameStartNs + FRAME_NS;
+
+        // a right spin toggles A, B, A, B, ... and the button is pressed and released mid frame
+        input.beginFrame();
+        for (; nextEdgeNs < frameEndNs; nextEdgeNs += EDGE_NS) {
+            bool onA = edges % 2 == 0;
+            bool& level = onA ? levelA : levelB;
+            level = !level;
+            input.pushEvent(InputEvent{
+                .pin = onA ? ENCODER_A : ENCODER_B,
+                .edge = level ? InputEvent::Edge::RISING : InputEvent::Edge::FALLING,
+                .timestampNs = nextEdgeNs,
+                .sequence = ++sequence,
+            });
+            edges++;
+        }
+        input.pushEvent(InputEvent{.pin = BUTTON_PIN,
+                                   .edge = InputEvent::Edge::RISING,
+                                   .timestampNs = frameStartNs + 1'000'000,
+                                   .sequence = ++sequence});
+        input.pushEvent(InputEvent{.pin = BUTTON_PIN,
+                                   .edge = InputEvent::Edge::FALLING,
+                                   .timestampNs = frameStartNs + 5'000'000,
+                                   .sequence = ++sequence});
+
+        int64_t stepsBefore = steps;
+        uint64_t cpuStartNs = dash::perf::bench::threadCpuNs();
+        input.endFrame();
+        uint64_t cpuNs = dash::perf::bench::threadCpuNs() - cpuStartNs;
+        cpuTotalNs += cpuNs;
+        cpuMaxNs = std::max(cpuMaxNs, cpuNs);
+
+        // the first edge only primes the encoder, every 4 after it is one detent
+        int64_t expectedSteps = static_cast<int64_t>((edges - 1) / 4);
+        bool ok = downs == frame + 1 && ups == frame + 1 && steps == expectedSteps &&
+                  input.isUpThisFrame(BUTTON_PIN) && !input.isDownThisFrame(BUTTON_PIN) &&
+                  input.deltaThisFrame(ENCODER_ID) == steps - stepsBefore &&
+                  input.isRightThisFrame(ENCODER_ID) == (steps != stepsBefore) &&
+                  !input.isLeftThisFrame(ENCODER_ID);
+        badFrames += ok ? 0 : 1;
+    }
+
+    input.unregisterButton(BUTTON_PIN);
+    input.unregisterEncoder(ENCODER_ID);
+
+    dash::perf::bench::report("InputManager::endFrame, 2kHz encoder", FRAMES, cpuTotalNs);
+    dash::perf::bench::report("InputManager::endFrame, per edge", edges + 2 * FRAMES, cpuTotalNs);
+    okay::Engine.logger.info("bench:   worst frame {:.1f}us cpu, {} steps, {} bad frames",
+                             cpuMaxNs / 1000.0,
+                             steps,
+                             badFrames);
+    if (badFrames != 0) {
+        dash::perf::bench::fail();
+    }
+}
+
+// the reduction run whenever a cell voltage frame changes, over all 140 cells
+static void __benchPackStats() {
+    constexpr size_t ITERATIONS = 1'000'000;
+
+    alignas(16) std::array<float, dash::PackStats::Voltages::NUM_CELLS> cells;
+    uint32_t seed = 0x2545F491;
+    for (float& cell : cells) {
+        seed = seed * 1664525u + 1013904223u;
+        cell = 3.3f + 0.012f * static_cast<float>(seed >> 28);  // 8 bit BMS steps
+    }
+
+    dash::CellStats stats{};
+    dash::perf::bench::measure("reduceCells, 140 cells", ITERATIONS, [&] {
+        stats = dash::reduceCells(cells.data(), cells.size());
+        dash::perf::bench::doNotOptimize(&stats);
+    });
+    dash::perf::bench::measure("reduceCellsScalar, 140 cells", ITERATIONS, [&] {
+        stats = dash::reduceCellsScalar(cells.data(), cells.size());
+        dash::perf::bench::doNotOptimize(&stats);
+    });
+
+    dash::CellStats batched = dash::reduceCells(cells.data(), cells.size());
+    dash::CellStats scalar = dash::reduceCellsScalar(cells.data(), cells.size());
+    bool match = batched.min == scalar.min && batched.max == scalar.max &&
+                 batched.argmin == scalar.argmin && batched.argmax == scalar.argmax &&
+                 std::fabs(batched.mean - scalar.mean) < 1e-5f &&
+                 std::fabs(batched.stddev - scalar.stddev) < 1e-5f;
+    okay::Engine.logger.info("bench:   min {:.3f}V (#{}), max {:.3f}V (#{}), std {:.1f}mV, {}",
+                             batched.min,
+                             batched.argmin,
+                             batched.max,
+                             batched.argmax,
+                             batched.stddev * 1000.0f,
+                             match ? "matches scalar" : "DIFFERS FROM SCALAR");
+    if (!match) {
+        dash::perf::bench::fail();
+    }
+}
+
+// a second of traffic: every received message of the drive bus at 100Hz, with payloads that
+// change every time so the decoders, derived signals and pack stats all have work to do
+static void __synthesizeCANLog(CANReplay& replay) {
+    constexpr uint64_t PERIOD_NS = 10'000'000;
+    constexpr size_t PERIODS = 100;
+
+    uint32_t seed = 0x2545F491;
+    for (size_t period = 0; period < PERIODS; period++) {
+        for (ICAN_Message* message : dbc::driveBus.get_messages()) {
+            if (message == &g_heartbeatMessage) continue;
+
+            CAN_Frame frame{};
+            message->encode_to_frame(frame);
+            for (uint8_t i = 0; i < frame.len; i++) {
+                seed = seed * 1664525u + 1013904223u;
+                frame.data[i] = static_cast<uint8_t>(seed >> 24);
+            }
+            replay.append(period * PERIOD_NS, frame);
+        }
+    }
+}
+
+// Drives the bus side of the frame loop (tick, derived signals, pack stats, LED bindings,
+// animations and the terminal tables) from a recorded CAN log at 1kHz, and fails if anything
+// still allocates after warmup. DASH_REPLAY_LOG names a `candump -L` log, without it a
+// synthesized one is used. Only meaningful in a -DDASH_ALLOC_TRACKING=ON build.
+static void __benchAllocReplay() {
+    constexpr size_t WARMUP_FRAMES = 120;
+    constexpr size_t FRAMES = 10'000;
+    constexpr uint64_t FRAME_NS = 1'000'000;
+
+    if (!dash::perf::allocTrackingEnabled()) {
+        okay::Engine.logger.warn("bench:   built without DASH_ALLOC_TRACKING, nothing to check");
+    }
+
+    auto replay = std::make_unique<CANReplay>();
+    CANReplay* log = replay.get();
+    const char* path = std::getenv("DASH_REPLAY_LOG");
+    if (path != nullptr) {
+        if (!log->load(path)) {
+            dash::perf::bench::fail();
+            return;
+        }
+    } else {
+        __synthesizeCANLog(*log);
+    }
+
+    dbc::driveBus.set_driver(std::make_unique<CANTap>(std::move(replay)));
+    BaudRate baud = BaudRate::kBaud500K;
+    dbc::driveBus.init(baud);
+
+    // the engine isn't running, so the bench brings up its own display
+    dash::NeopixelManager display;
+    display.initialize();
+
+    __collectPrintedSignals();
+    g_derivedSignals.attach(dbc::derived::SIGNALS);
+    g_packStats.attach(dbc::driveBus);
+    g_animations.attach(display);
+    __startAnimations(false);
+    __bindLights(display);
+
+    constexpr size_t NUM_STAGES = static_cast<size_t>(dash::perf::Stage::COUNT);
+    std::array<uint64_t, NUM_STAGES> allocations{};
+    uint64_t startNs = dash::perf::monotonicNs();
+    for (size_t frame = 0; frame < WARMUP_FRAMES + FRAMES; frame++) {
+        log->advance(FRAME_NS);
+        dash::perf::beginFrame();
+
+        {
+            dash::perf::AllocScope scope{dash::perf::Stage::CAN};
+            uint64_t tickStartNs = dash::perf::latency::nowNs();
+            __tickBus();
+            __consumeBus(__sampleBus(tickStartNs));
+        }
+
+        {
+            dash::perf::AllocScope scope{dash::perf::Stage::LIGHTS};
+            g_animations.update(__nowMs());
+            display.updateDisplay();
+        }
+
+        {
+            dash::perf::AllocScope scope{dash::perf::Stage::DISPLAY};
+            g_frame.clear();
+            __snapshotSignalTable();
+            __formatSignalTable();
+            __drawPackStats();
+        }
+
+        dash::perf::endFrame();
+        if (frame < WARMUP_FRAMES) continue;
+
+        for (size_t stage = 0; stage < NUM_STAGES; stage++) {
+            auto id = static_cast<dash::perf::Stage>(stage);
+            allocations[stage] += dash::perf::frameAllocations(id);
+        }
+    }
+    uint64_t elapsedNs = dash::perf::monotonicNs() - startNs;
+    display.shutdown();
+
+    uint64_t total = 0;
+    for (uint64_t count : allocations) {
+        total += count;
+    }
+
+    dash::perf::bench::report("replayed frame", WARMUP_FRAMES + FRAMES, elapsedNs);
+    okay::Engine.logger.info("bench:   {} log frames, {} laps, {} allocations after warmup "
+                             "(can {}, lights {}, display {})",
+                             log->size(),
+                             log->laps(),
+                             total,
+                             allocations[static_cast<size_t>(dash::perf::Stage::CAN)],
+                             allocations[static_cast<size_t>(dash::perf::Stage::LIGHTS)],
+                             allocations[static_cast<size_t>(dash::perf::Stage::DISPLAY)]);
+    if (total != 0) {
+        okay::Engine.logger.error("bench:   the frame loop allocates in steady state");
+        dash::perf::bench::fail();
+    }
 }
@@ -3,6 +3,8 @@
 # dash application
 set(SOURCES
     ${OKAY_PROJECT_ROOT_DIR}/main.cpp
+    ${OKAY_PROJECT_ROOT_DIR}/can/can_link.cpp
+    ${OKAY_PROJECT_ROOT_DIR}/can/can_replay.cpp
     ${OKAY_PROJECT_ROOT_DIR}/can/mock/can_imgui.cpp
 )
 
@@ -19,6 +21,12 @@ add_subdirectory(
     ${CMAKE_CURRENT_BINARY_DIR}/dash_drivers_can
 ) # produces static lib nfr_canlib
 
+# instrumentation, used by both the dash and the platform layer
+add_subdirectory(
+    ${OKAY_PROJECT_ROOT_DIR}/perf
+    ${CMAKE_CURRENT_BINARY_DIR}/dash_perf
+)
+
 # add platform-specific functionalities
 add_subdirectory(
     ${OKAY_PROJECT_ROOT_DIR}/platform
@@ -26,6 +34,6 @@ add_subdirectory(
 )
 
 target_sources(${PROJECT} PRIVATE ${SOURCES})
-target_link_libraries(${PROJECT} PRIVATE dash_platform)
+target_link_libraries(${PROJECT} PRIVATE dash_platform dash_perf)
 target_include_directories(${PROJECT} PRIVATE ${INCLUDES})
 
@@ -0,0 +1,247 @@
+#ifdef DASH_ALLOC_TRACKING
+
+#include <perf/alloc_tracker.hpp>
+#include <okay/core/okay.hpp>
+
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+namespace dash::perf {
+
+static constexpr size_t NUM_STAGES = static_cast<size_t>(Stage::COUNT);
+static constexpr const char* STAGE_NAMES[NUM_STAGES] = {
+    "other", "can", "lights", "input", "display", "platform"};
+
+// everything the hooks touch is constant-initialised, so allocations during static init and
+// thread start are safe to count
+static std::array<std::atomic<uint64_t>, NUM_STAGES> s_stageCounts{};
+static std::atomic<uint64_t> s_backgroundCount{0};
+static std::array<uint64_t, NUM_STAGES> s_frameStart{};
+static std::array<uint64_t, NUM_STAGES> s_lastFrame{};
+static std::atomic<bool> s_armed{false};
+static std::atomic<bool> s_abortOnAlloc{false};
+static uint32_t s_warmupFrames = 0;
+static bool s_pendingArm = false;
+static uint64_t s_frameNumber = 0;
+
+static thread_local Stage t_stage = Stage::OTHER;
+static thread_local bool t_suppressed = false;
+// set by beginFrame, only the thread running the frame is attributed to stages and checked.
+// workers (CAN link, GPIO events, trace buffers) are counted on their own
+static thread_local bool t_frameThread = false;
+
+static void recordAllocation() {
+    if (t_suppressed) {
+        return;
+    }
+
+    if (!t_frameThread) {
+        s_backgroundCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    s_stageCounts[static_cast<size_t>(t_stage)].fetch_add(1, std::memory_order_relaxed);
+
+    if (s_armed.load(std::memory_order_relaxed) &&
+        s_abortOnAlloc.load(std::memory_order_relaxed)) {
+        static constexpr char MSG[] = "dash: heap allocation in steady state, aborting\n";
+        ::write(STDERR_FILENO, MSG, sizeof(MSG) - 1);
+        std::abort();
+    }
+}
+
+AllocScope::AllocScope(Stage stage) : _previous(t_stage) {
+    t_stage = stage;
+}
+
+AllocScope::~AllocScope() {
+    t_stage = _previous;
+}
+
+void beginFrame() {
+    t_frameThread = true;
+    for (size_t i = 0; i < NUM_STAGES; i++) {
+        s_frameStart[i] = s_stageCounts[i].load(std::memory_order_relaxed);
+    }
+}
+
+void endFrame() {
+    uint64_t frameTotal = 0;
+    for (size_t i = 0; i < NUM_STAGES; i++) {
+        s_lastFrame[i] = s_stageCounts[i].load(std::memory_order_relaxed) - s_frameStart[i];
+        frameTotal += s_lastFrame[i];
+    }
+    s_frameNumber++;
+
+    if (s_pendingArm) {
+        if (s_warmupFrames > 0) {
+            s_warmupFrames--;
+            return;
+        }
+        s_pendingArm = false;
+        t_suppressed = true;
+        okay::Engine.logger.info("Allocation tracking armed at frame {}", s_frameNumber);
+        t_suppressed = false;
+        s_armed = true;
+        return;
+    }
+
+    if (!s_armed || frameTotal == 0) {
+        return;
+    }
+
+    // reporting allocates, don't count it against the next frame
+    t_suppressed = true;
+    okay::Engine.logger.warn(
+        "frame {}: {} allocations (can {}, lights {}, input {}, display {}, platform {}, other {})",
+        s_frameNumber,
+        frameTotal,
+        s_lastFrame[static_cast<size_t>(Stage::CAN)],
+        s_lastFrame[static_cast<size_t>(Stage::LIGHTS)],
+        s_lastFrame[static_cast<size_t>(Stage::INPUT)],
+        s_lastFrame[static_cast<size_t>(Stage::DISPLAY)],
+        s_lastFrame[static_cast<size_t>(Stage::PLATFORM)],
+        s_lastFrame[static_cast<size_t>(Stage::OTHER)]);
+    t_suppressed = false;
+}
+
+void armSteadyState(uint32_t warmupFrames, bool abortOnAlloc) {
+    s_warmupFrames = warmupFrames;
+    s_abortOnAlloc = abortOnAlloc;
+    s_pendingArm = true;
+}
+
+uint64_t frameAllocations(Stage stage) {
+    return s_lastFrame[static_cast<size_t>(stage)];
+}
+
+uint64_t totalAllocations() {
+    uint64_t total = 0;
+    for (const auto& count : s_stageCounts) {
+        total += count.load(std::memory_order_relaxed);
+    }
+    return total + s_backgroundCount.load(std::memory_order_relaxed);
+}
+
+}  // namespace dash::perf
+
+#if defined(__GLIBC__)
+
+// glibc: forward the malloc family to the real allocator. operator new goes through malloc and
+// the aligned operator new through aligned_alloc, so this catches all of them.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) {
+    dash::perf::recordAllocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    dash::perf::recordAllocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    dash::perf::recordAllocation();
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    dash::perf::recordAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    dash::perf::recordAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+// glibc has no __libc_ entry for these, so the alignment checks are done here
+int posix_memalign(void** ptr, size_t alignment, size_t size) {
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+
+    dash::perf::recordAllocation();
+    void* block = __libc_memalign(alignment, size);
+    if (block == nullptr) {
+        return ENOMEM;
+    }
+    *ptr = block;
+    return 0;
+}
+}
+
+#else
+
+void* operator new(std::size_t size) {
+    dash::perf::recordAllocation();
+    if (void* ptr = std::malloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+// over-aligned types go through their own overloads, which would otherwise use the default
+// allocator behind our back
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    dash::perf::recordAllocation();
+    std::size_t align = static_cast<std::size_t>(alignment);
+    if (void* ptr = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+#endif  // __GLIBC__
+
+#endif  // DASH_ALLOC_TRACKING
@@ -0,0 +1,68 @@
+#ifndef __ALLOC_TRACKER_HPP__
+#define __ALLOC_TRACKER_HPP__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dash::perf {
+
+// stages of a frame that allocations are attributed to
+enum class Stage : uint8_t {
+    OTHER,
+    CAN,
+    LIGHTS,
+    INPUT,
+    DISPLAY,
+    PLATFORM,
+    COUNT
+};
+
+#ifdef DASH_ALLOC_TRACKING
+
+constexpr bool allocTrackingEnabled() { return true; }
+
+// attributes allocations made by this thread to a stage until destroyed
+class AllocScope {
+   public:
+    explicit AllocScope(Stage stage);
+    ~AllocScope();
+
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+   private:
+    Stage _previous;
+};
+
+// the thread calling beginFrame is the frame thread; only its allocations are attributed to stages
+// and checked in steady state, other threads' are only counted in totalAllocations
+void beginFrame();
+void endFrame();
+
+// after warmupFrames more frames, any frame that allocates is reported. with abortOnAlloc,
+// the allocation itself aborts so the offending call is on the stack.
+void armSteadyState(uint32_t warmupFrames, bool abortOnAlloc);
+
+uint64_t frameAllocations(Stage stage);
+uint64_t totalAllocations();
+
+#else
+
+constexpr bool allocTrackingEnabled() { return false; }
+
+class AllocScope {
+   public:
+    explicit AllocScope(Stage) {}
+};
+
+inline void beginFrame() {}
+inline void endFrame() {}
+inline void armSteadyState(uint32_t, bool) {}
+inline uint64_t frameAllocations(Stage) { return 0; }
+inline uint64_t totalAllocations() { return 0; }
+
+#endif  // DASH_ALLOC_TRACKING
+
+}  // namespace dash::perf
+
+#endif  // __ALLOC_TRACKER_HPP__
@@ -0,0 +1,69 @@
+#include <perf/bench.hpp>
+#include <okay/core/okay.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+namespace dash::perf::bench {
+
+static bool s_failed = false;
+
+static bool selected(std::string_view selection, std::string_view name) {
+    if (selection == "all") {
+        return true;
+    }
+
+    while (!selection.empty()) {
+        size_t comma = selection.find(',');
+        if (selection.substr(0, comma) == name) {
+            return true;
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        selection.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+bool runFromEnvironment(std::span<const Case> cases) {
+    const char* env = std::getenv("DASH_BENCH");
+    if (env == nullptr || env[0] == '\0') {
+        return false;
+    }
+
+    size_t ran = 0;
+    for (const Case& benchCase : cases) {
+        if (!selected(env, benchCase.name)) {
+            continue;
+        }
+
+        okay::Engine.logger.info("bench: {}", benchCase.name);
+        benchCase.run();
+        ran++;
+    }
+
+    if (ran == 0) {
+        okay::Engine.logger.error("bench: no case matches DASH_BENCH={}", env);
+        fail();
+    }
+    return true;
+}
+
+void fail() {
+    s_failed = true;
+}
+
+bool failed() {
+    return s_failed;
+}
+
+void report(const char* label, size_t iterations, uint64_t elapsedNs) {
+    okay::Engine.logger.info("bench:   {:<32} {:>10.1f}ns/iter ({} iterations)",
+                             label,
+                             static_cast<double>(elapsedNs) / static_cast<double>(iterations),
+                             iterations);
+}
+
+}  // namespace dash::perf::bench
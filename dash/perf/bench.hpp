@@ -0,0 +1,58 @@
+#ifndef __BENCH_HPP__
+#define __BENCH_HPP__
+
+#include <perf/clock.hpp>
+
+#include <time.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// In-app microbenchmarks. Running with DASH_BENCH=<case>[,<case>...] (or DASH_BENCH=all) runs
+// the named cases before the engine starts and exits, so they measure the same build, flags and
+// hardware the dash runs on.
+namespace dash::perf::bench {
+
+struct Case {
+    const char* name;
+    void (*run)();
+};
+
+// runs the cases selected by DASH_BENCH, returns false when it isn't set
+bool runFromEnvironment(std::span<const Case> cases);
+
+void report(const char* label, size_t iterations, uint64_t elapsedNs);
+
+// for cases that check something as well as time it, makes the process exit non-zero
+void fail();
+bool failed();
+
+// CPU time consumed by the calling thread, unlike wall time this excludes sleeps and preemption
+inline uint64_t threadCpuNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// keeps the compiler from dropping work whose result is never read
+inline void doNotOptimize(const void* ptr) {
+    asm volatile("" : : "r"(ptr) : "memory");
+}
+
+template <typename Fn>
+void measure(const char* label, size_t iterations, Fn&& fn) {
+    for (size_t i = 0; i < iterations / 10; i++) {
+        fn();
+    }
+
+    uint64_t startNs = monotonicNs();
+    for (size_t i = 0; i < iterations; i++) {
+        fn();
+    }
+    report(label, iterations, monotonicNs() - startNs);
+}
+
+}  // namespace dash::perf::bench
+
+#endif  // __BENCH_HPP__
@@ -0,0 +1,19 @@
+#ifndef __PERF_CLOCK_HPP__
+#define __PERF_CLOCK_HPP__
+
+#include <time.h>
+
+#include <cstdint>
+
+namespace dash::perf {
+
+// CLOCK_MONOTONIC in ns, the timebase shared by all the instrumentation (and libgpiod events)
+inline uint64_t monotonicNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+}  // namespace dash::perf
+
+#endif  // __PERF_CLOCK_HPP__
@@ -0,0 +1,205 @@
+#include <perf/latency_probe.hpp>
+#include <perf/clock.hpp>
+#include <okay/core/okay.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+namespace dash::perf::latency {
+
+// 100us buckets out to 50ms, the last bucket collects everything slower
+static constexpr uint64_t BUCKET_NS = 100'000;
+static constexpr size_t NUM_BUCKETS = 500;
+static constexpr uint64_t REPORT_PERIOD_NS = 5'000'000'000ULL;
+
+class Histogram {
+   public:
+    void record(uint64_t latencyNs) {
+        size_t bucket = static_cast<size_t>(latencyNs / BUCKET_NS);
+        _buckets[bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1]++;
+        _count++;
+        if (latencyNs > _maxNs) {
+            _maxNs = latencyNs;
+        }
+    }
+
+    // upper edge of the bucket holding the given percentile, in ms
+    double percentileMs(double percentile) const {
+        uint64_t target = static_cast<uint64_t>(percentile * static_cast<double>(_count));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < NUM_BUCKETS; i++) {
+            seen += _buckets[i];
+            if (seen > target) {
+                return static_cast<double>((i + 1) * BUCKET_NS) / 1e6;
+            }
+        }
+        return static_cast<double>(NUM_BUCKETS * BUCKET_NS) / 1e6;
+    }
+
+    double maxMs() const { return static_cast<double>(_maxNs) / 1e6; }
+    uint64_t count() const { return _count; }
+
+   private:
+    std::array<uint32_t, NUM_BUCKETS> _buckets{};
+    uint64_t _count = 0;
+    uint64_t _maxNs = 0;
+};
+
+struct Sample {
+    bool active = false;
+    uint64_t arrivalNs = 0;
+    bool decoded = false;
+    bool lightsPending = false;
+    bool led = false;
+    bool terminal = false;
+};
+
+static bool s_enabled = false;
+static Sample s_sample;
+static Histogram s_decode;
+static Histogram s_ledSubmit;
+static Histogram s_ledComplete;
+static Histogram s_terminal;
+static uint64_t s_lastReportNs = 0;
+
+// arrival of the latest frame of every standard id, 0 once a sample has taken it. written by
+// whichever thread receives frames, read from the main loop
+static constexpr uint32_t MAX_FRAME_ID = 0x7FF;
+static std::array<std::atomic<uint64_t>, MAX_FRAME_ID + 1> s_arrivalNs{};
+
+// the latest frame->complete latency, left by whichever thread saw the transfer end for the main
+// loop to record. 0 when there's none
+static std::atomic<uint64_t> s_ledCompleteNs{0};
+
+uint64_t nowNs() {
+    return monotonicNs();
+}
+
+void configureFromEnvironment() {
+    const char* value = std::getenv("DASH_LATENCY_PROBE");
+    s_enabled = value != nullptr && std::strcmp(value, "0") != 0;
+    if (s_enabled) {
+        okay::Engine.logger.info("Latency probe enabled");
+        s_lastReportNs = nowNs();
+    }
+}
+
+bool enabled() {
+    return s_enabled;
+}
+
+void onFrameArrival(uint32_t frameID, uint64_t arrivalNs) {
+    if (!s_enabled) {
+        return;
+    }
+
+    if (frameID <= MAX_FRAME_ID) {
+        s_arrivalNs[frameID].store(arrivalNs, std::memory_order_relaxed);
+    }
+}
+
+static void collectLedComplete() {
+    uint64_t latencyNs = s_ledCompleteNs.exchange(0, std::memory_order_relaxed);
+    if (latencyNs != 0) {
+        s_ledComplete.record(latencyNs);
+    }
+}
+
+void beginSample(uint32_t frameID, uint64_t fallbackNs) {
+    if (!s_enabled) {
+        return;
+    }
+
+    // the previous sample's transfer has to be recorded before this one's can end
+    collectLedComplete();
+
+    uint64_t arrivalNs = 0;
+    if (frameID <= MAX_FRAME_ID) {
+        arrivalNs = s_arrivalNs[frameID].exchange(0, std::memory_order_relaxed);
+    }
+    if (arrivalNs == 0) {
+        arrivalNs = fallbackNs;
+    }
+
+    // a newer value supersedes whatever was still in flight
+    s_sample = Sample{.active = true, .arrivalNs = arrivalNs};
+}
+
+void markDecoded() {
+    if (!s_sample.active || s_sample.decoded) {
+        return;
+    }
+
+    s_decode.record(nowNs() - s_sample.arrivalNs);
+    s_sample.decoded = true;
+}
+
+void markLights() {
+    if (s_sample.active && s_sample.decoded && !s_sample.led) {
+        s_sample.lightsPending = true;
+    }
+}
+
+uint64_t markLedSubmitted() {
+    if (!s_sample.active || !s_sample.lightsPending) {
+        return 0;
+    }
+
+    s_ledSubmit.record(nowNs() - s_sample.arrivalNs);
+    s_sample.lightsPending = false;
+    s_sample.led = true;
+    return s_sample.arrivalNs;
+}
+
+void markLedComplete(uint64_t sampleNs) {
+    if (sampleNs == 0) {
+        return;
+    }
+
+    s_ledCompleteNs.store(nowNs() - sampleNs, std::memory_order_relaxed);
+}
+
+void markTerminal() {
+    if (!s_sample.active || !s_sample.decoded || s_sample.terminal) {
+        return;
+    }
+
+    s_terminal.record(nowNs() - s_sample.arrivalNs);
+    s_sample.terminal = true;
+}
+
+static void logHistogram(const char* name, const Histogram& histogram) {
+    if (histogram.count() == 0) {
+        return;
+    }
+
+    okay::Engine.logger.info("latency {}: n={} p50={:.1f}ms p90={:.1f}ms p99={:.1f}ms max={:.2f}ms",
+                             name,
+                             histogram.count(),
+                             histogram.percentileMs(0.50),
+                             histogram.percentileMs(0.90),
+                             histogram.percentileMs(0.99),
+                             histogram.maxMs());
+}
+
+void tick() {
+    if (!s_enabled) {
+        return;
+    }
+
+    uint64_t now = nowNs();
+    if (now - s_lastReportNs < REPORT_PERIOD_NS) {
+        return;
+    }
+    s_lastReportNs = now;
+    collectLedComplete();
+
+    logHistogram("frame->decode", s_decode);
+    logHistogram("frame->led submit", s_ledSubmit);
+    logHistogram("frame->led complete", s_ledComplete);
+    logHistogram("frame->terminal", s_terminal);
+}
+
+}  // namespace dash::perf::latency
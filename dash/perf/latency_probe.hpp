@@ -0,0 +1,39 @@
+#ifndef __LATENCY_PROBE_HPP__
+#define __LATENCY_PROBE_HPP__
+
+#include <cstdint>
+
+// End-to-end latency probe. A sample starts when the probe signal changes after a bus tick,
+// stamped with the arrival time of its frame, and is followed through decode, the lights update,
+// the LED frame's submission to the driver, the end of its transfer and the terminal write.
+// Distributions are logged every few seconds while the probe is enabled (DASH_LATENCY_PROBE=1).
+namespace dash::perf::latency {
+
+void configureFromEnvironment();
+bool enabled();
+
+uint64_t nowNs();
+
+// called for every received frame, with the best arrival timestamp the driver has
+void onFrameArrival(uint32_t frameID, uint64_t arrivalNs);
+
+// starts a sample for a decoded change of the probe signal carried by frameID, stamped with the
+// latest arrival of that id. if it wasn't seen since the last sample, fallbackNs is used instead
+void beginSample(uint32_t frameID, uint64_t fallbackNs);
+
+void markDecoded();
+void markLights();
+// the LED frame was handed to the DMA engine or SPI worker. returns the sample's arrival when the
+// frame carries it, 0 otherwise, for the backend to pass to markLedComplete once it's sent
+uint64_t markLedSubmitted();
+// the frame markLedSubmitted returned sampleNs for has been clocked out to the strip. can be
+// called from any thread, and does nothing for 0
+void markLedComplete(uint64_t sampleNs);
+void markTerminal();
+
+// logs the distributions every few seconds
+void tick();
+
+}  // namespace dash::perf::latency
+
+#endif  // __LATENCY_PROBE_HPP__
@@ -0,0 +1,132 @@
+#include <perf/startup_profiler.hpp>
+#include <okay/core/okay.hpp>
+
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+namespace dash::perf::startup {
+
+static constexpr size_t MAX_MARKS = 48;
+static constexpr uint64_t REPORT_TIMEOUT_NS = 15'000'000'000ULL;
+static constexpr size_t NUM_MILESTONES = static_cast<size_t>(Milestone::COUNT);
+static constexpr const char* MILESTONE_NAMES[NUM_MILESTONES] = {"first LED frame",
+                                                                "first CAN frame"};
+
+struct Mark {
+    const char* name;
+    uint64_t bootNs;
+};
+
+static std::array<Mark, MAX_MARKS> s_marks{};
+static std::atomic<size_t> s_numMarks{0};
+static std::array<std::atomic<uint64_t>, NUM_MILESTONES> s_milestones{};
+static bool s_reported = false;
+
+static uint64_t bootNs() {
+    timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// process start in CLOCK_BOOTTIME ns, from field 22 of /proc/self/stat
+static uint64_t processStartBootNs() {
+    static const uint64_t start = []() -> uint64_t {
+        FILE* file = std::fopen("/proc/self/stat", "r");
+        if (file == nullptr) {
+            return bootNs();
+        }
+
+        char buffer[1024] = {};
+        size_t len = std::fread(buffer, 1, sizeof(buffer) - 1, file);
+        std::fclose(file);
+        buffer[len] = '\0';
+
+        // the command name may contain spaces, fields are counted from after its ')'
+        const char* field = std::strrchr(buffer, ')');
+        unsigned long long startTicks = 0;
+        if (field == nullptr ||
+            std::sscanf(field + 2,
+                        "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d "
+                        "%*d %*d %llu",
+                        &startTicks) != 1) {
+            return bootNs();
+        }
+
+        return static_cast<uint64_t>(startTicks) * 1'000'000'000ULL /
+               static_cast<uint64_t>(sysconf(_SC_CLK_TCK));
+    }();
+    return start;
+}
+
+void mark(const char* name) {
+    size_t idx = s_numMarks.fetch_add(1);
+    if (idx >= MAX_MARKS) {
+        return;
+    }
+    s_marks[idx] = Mark{name, bootNs()};
+}
+
+void milestone(Milestone milestone) {
+    auto& slot = s_milestones[static_cast<size_t>(milestone)];
+    if (slot.load(std::memory_order_relaxed) != 0) {
+        return;
+    }
+
+    uint64_t expected = 0;
+    if (slot.compare_exchange_strong(expected, bootNs())) {
+        mark(MILESTONE_NAMES[static_cast<size_t>(milestone)]);
+    }
+}
+
+static double ms(uint64_t ns) {
+    return static_cast<double>(ns) / 1e6;
+}
+
+void tick() {
+    if (s_reported) {
+        return;
+    }
+
+    bool allReached = true;
+    for (const auto& slot : s_milestones) {
+        allReached = allReached && slot.load(std::memory_order_relaxed) != 0;
+    }
+
+    uint64_t processStart = processStartBootNs();
+    if (!allReached && bootNs() - processStart < REPORT_TIMEOUT_NS) {
+        return;
+    }
+    s_reported = true;
+
+    okay::Engine.logger.info("startup: process started {:.0f}ms after boot", ms(processStart));
+
+    size_t numMarks = std::min(s_numMarks.load(), MAX_MARKS);
+    for (size_t i = 0; i < numMarks; i++) {
+        okay::Engine.logger.info("startup: +{:8.1f}ms  {}",
+                                 ms(s_marks[i].bootNs - processStart),
+                                 s_marks[i].name);
+    }
+
+    for (size_t i = 0; i < NUM_MILESTONES; i++) {
+        uint64_t reached = s_milestones[i].load(std::memory_order_relaxed);
+        if (reached == 0) {
+            okay::Engine.logger.warn("startup: no {} within {:.0f}s",
+                                     MILESTONE_NAMES[i],
+                                     ms(REPORT_TIMEOUT_NS) / 1000.0);
+            continue;
+        }
+
+        okay::Engine.logger.info("startup: time to {}: {:.1f}ms from boot, {:.1f}ms from start",
+                                 MILESTONE_NAMES[i],
+                                 ms(reached),
+                                 ms(reached - processStart));
+    }
+}
+
+}  // namespace dash::perf::startup
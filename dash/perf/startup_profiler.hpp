@@ -0,0 +1,28 @@
+#ifndef __STARTUP_PROFILER_HPP__
+#define __STARTUP_PROFILER_HPP__
+
+#include <cstdint>
+
+// Boot-to-first-frame timeline. Marks are recorded relative to kernel boot (roughly LV
+// power-on) and to process start, and logged once the first LED frame and the first CAN frame
+// have both happened (or after a timeout, so a dead bus still gets a report).
+namespace dash::perf::startup {
+
+enum class Milestone : uint8_t {
+    FIRST_LED_FRAME,
+    FIRST_CAN_FRAME,
+    COUNT
+};
+
+// thread-safe, name must be a string literal
+void mark(const char* name);
+
+// records the milestone the first time it's reached, cheap afterwards
+void milestone(Milestone milestone);
+
+// logs the timeline once, call every frame
+void tick();
+
+}  // namespace dash::perf::startup
+
+#endif  // __STARTUP_PROFILER_HPP__
@@ -0,0 +1,195 @@
+#include <perf/trace.hpp>
+#include <perf/clock.hpp>
+#include <okay/core/okay.hpp>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace dash::perf::trace {
+
+static constexpr size_t EVENTS_PER_THREAD = 8192;
+static constexpr size_t MAX_THREADS = 16;
+
+struct Event {
+    const char* name;
+    uint64_t timestampNs;
+    int64_t value;
+    char phase;
+};
+
+// single producer (the owning thread); the dumper reads behind the head and drops anything
+// the producer may have overwritten while it was reading
+struct ThreadBuffer {
+    std::array<Event, EVENTS_PER_THREAD> events{};
+    std::atomic<uint64_t> head{0};
+    uint32_t tid = 0;
+    const char* name = nullptr;
+};
+
+static std::array<std::atomic<ThreadBuffer*>, MAX_THREADS> s_buffers{};
+static std::atomic<size_t> s_numBuffers{0};
+static std::atomic<bool> s_enabled{false};
+static std::atomic<bool> s_dumpRequested{false};
+static std::string s_path = "dash_trace.json";
+
+static thread_local ThreadBuffer* t_buffer = nullptr;
+static thread_local bool t_registrationFailed = false;
+
+static ThreadBuffer* threadBuffer() {
+    if (t_buffer != nullptr || t_registrationFailed) {
+        return t_buffer;
+    }
+
+    size_t slot = s_numBuffers.fetch_add(1);
+    if (slot >= MAX_THREADS) {
+        t_registrationFailed = true;
+        return nullptr;
+    }
+
+    // never freed: the dump may run after the thread has exited
+    t_buffer = new ThreadBuffer();
+    t_buffer->tid = static_cast<uint32_t>(syscall(SYS_gettid));
+    s_buffers[slot].store(t_buffer, std::memory_order_release);
+    return t_buffer;
+}
+
+static void record(char phase, const char* name, int64_t value) {
+    if (!s_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    ThreadBuffer* buffer = threadBuffer();
+    if (buffer == nullptr) {
+        return;
+    }
+
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    buffer->events[head % EVENTS_PER_THREAD] = Event{name, monotonicNs(), value, phase};
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void begin(const char* name) {
+    record('B', name, 0);
+}
+
+void end(const char* name) {
+    record('E', name, 0);
+}
+
+void counter(const char* name, int64_t value) {
+    record('C', name, value);
+}
+
+void setThreadName(const char* name) {
+    if (ThreadBuffer* buffer = threadBuffer()) {
+        buffer->name = name;
+    }
+}
+
+static void __onDumpSignal(int) {
+    s_dumpRequested.store(true, std::memory_order_relaxed);
+}
+
+void configureFromEnvironment() {
+    const char* path = std::getenv("DASH_TRACE");
+    if (path == nullptr || std::strcmp(path, "0") == 0) {
+        return;
+    }
+
+    if (std::strcmp(path, "1") != 0) {
+        s_path = path;
+    }
+
+    std::signal(SIGUSR1, __onDumpSignal);
+    s_enabled = true;
+    okay::Engine.logger.info("Tracing enabled, send SIGUSR1 to write {}", s_path);
+}
+
+bool enabled() {
+    return s_enabled.load(std::memory_order_relaxed);
+}
+
+static void writeEvent(FILE* file, bool& first, const ThreadBuffer& buffer, const Event& event) {
+    std::fprintf(file,
+                 "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u",
+                 first ? "" : ",",
+                 event.name,
+                 event.phase,
+                 static_cast<double>(event.timestampNs) / 1000.0,
+                 buffer.tid);
+    if (event.phase == 'C') {
+        std::fprintf(file, ",\"args\":{\"value\":%lld}", static_cast<long long>(event.value));
+    }
+    std::fputc('}', file);
+    first = false;
+}
+
+bool dump() {
+    if (!enabled()) {
+        return false;
+    }
+
+    FILE* file = std::fopen(s_path.c_str(), "w");
+    if (file == nullptr) {
+        okay::Engine.logger.error("Unable to open trace file {}", s_path);
+        return false;
+    }
+
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+    bool first = true;
+
+    size_t numBuffers = std::min(s_numBuffers.load(), MAX_THREADS);
+    for (size_t i = 0; i < numBuffers; i++) {
+        const ThreadBuffer* buffer = s_buffers[i].load(std::memory_order_acquire);
+        if (buffer == nullptr) {
+            continue;
+        }
+
+        if (buffer->name != nullptr) {
+            std::fprintf(file,
+                         "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                         "\"args\":{\"name\":\"%s\"}}",
+                         first ? "" : ",",
+                         buffer->tid,
+                         buffer->name);
+            first = false;
+        }
+
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t tail = head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0;
+        for (uint64_t idx = tail; idx < head; idx++) {
+            Event event = buffer->events[idx % EVENTS_PER_THREAD];
+
+            // the producer lapped us, this slot now holds a newer event (head idx + N already
+            // maps to the same slot)
+            uint64_t current = buffer->head.load(std::memory_order_acquire);
+            if (idx + EVENTS_PER_THREAD <= current) {
+                continue;
+            }
+            writeEvent(file, first, *buffer, event);
+        }
+    }
+
+    std::fputs("\n]}\n", file);
+    std::fclose(file);
+
+    okay::Engine.logger.info("Trace written to {}", s_path);
+    return true;
+}
+
+void poll() {
+    if (s_dumpRequested.exchange(false, std::memory_order_relaxed)) {
+        dump();
+    }
+}
+
+}  // namespace dash::perf::trace
@@ -0,0 +1,47 @@
+#ifndef __TRACE_HPP__
+#define __TRACE_HPP__
+
+#include <cstdint>
+
+// Low-overhead timeline tracing. Each thread records begin/end/counter events into its own
+// ring buffer, which is dumped as Chrome trace JSON (chrome://tracing, ui.perfetto.dev) on
+// SIGUSR1 or at shutdown. Names must be string literals, only the pointer is recorded.
+namespace dash::perf::trace {
+
+void begin(const char* name);
+void end(const char* name);
+void counter(const char* name, int64_t value);
+
+// names the calling thread in the dump
+void setThreadName(const char* name);
+
+// DASH_TRACE=<path> enables tracing and sets where the dump is written ("1" for the default)
+void configureFromEnvironment();
+bool enabled();
+
+// dumps every thread's buffer to the configured path
+bool dump();
+
+// dumps if a SIGUSR1 came in since the last call; call from the main loop, not the handler
+void poll();
+
+class Scope {
+   public:
+    explicit Scope(const char* name) : _name(name) { begin(_name); }
+    ~Scope() { end(_name); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    const char* _name;
+};
+
+}  // namespace dash::perf::trace
+
+#define DASH_TRACE_CONCAT_INNER(a, b) a##b
+#define DASH_TRACE_CONCAT(a, b) DASH_TRACE_CONCAT_INNER(a, b)
+#define DASH_TRACE_SCOPE(name) \
+    ::dash::perf::trace::Scope DASH_TRACE_CONCAT(__traceScope, __LINE__) { name }
+
+#endif  // __TRACE_HPP__
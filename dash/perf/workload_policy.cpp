@@ -0,0 +1,95 @@
+#include <perf/workload_policy.hpp>
+#include <perf/clock.hpp>
+#include <okay/core/okay.hpp>
+
+#include <time.h>
+
+namespace dash::perf {
+
+static uint64_t periodNs(float hz) {
+    return hz > 0.0f ? static_cast<uint64_t>(1e9f / hz) : 0;
+}
+
+const char* driveStateName(DriveState state) {
+    switch (state) {
+        case DriveState::IDLE:
+            return "IDLE";
+        case DriveState::PRECHARGE:
+            return "PRECHARGE";
+        case DriveState::NEUTRAL:
+            return "NEUTRAL";
+        case DriveState::DRIVE:
+            return "DRIVE";
+        case DriveState::FAULT:
+        case DriveState::COUNT:
+            break;
+    }
+    return "FAULT";
+}
+
+WorkloadGovernor::WorkloadGovernor(const WorkloadPolicyTable& table) : _table(table) {}
+
+void WorkloadGovernor::setDriveState(uint8_t rawState) {
+    DriveState state = rawState < NUM_DRIVE_STATES ? static_cast<DriveState>(rawState)
+                                                   : DriveState::FAULT;
+    if (state == _state) {
+        return;
+    }
+
+    _state = state;
+    // let every stage run once straight away in the new state
+    _lastRunNs.fill(0);
+}
+
+bool WorkloadGovernor::shouldRun(WorkStage stage, uint64_t nowNs) {
+    size_t idx = static_cast<size_t>(stage);
+    uint64_t period = periodNs(policy().stageHz[idx]);
+
+    if (period != 0 && _lastRunNs[idx] != 0 && nowNs - _lastRunNs[idx] < period) {
+        _shed[idx]++;
+        return false;
+    }
+
+    _lastRunNs[idx] = nowNs;
+    _runs[idx]++;
+    return true;
+}
+
+void WorkloadGovernor::throttleLoop(uint64_t frameStartNs) {
+    float loopHz = policy().loopHz;
+    if (_busOnLoop && loopHz > 0.0f && loopHz < BUS_LOOP_HZ) {
+        loopHz = BUS_LOOP_HZ;
+    }
+
+    uint64_t period = periodNs(loopHz);
+    if (period == 0) {
+        return;
+    }
+
+    uint64_t deadline = frameStartNs + period;
+    if (monotonicNs() >= deadline) {
+        return;
+    }
+
+    timespec ts{};
+    ts.tv_sec = static_cast<time_t>(deadline / 1'000'000'000ULL);
+    ts.tv_nsec = static_cast<long>(deadline % 1'000'000'000ULL);
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+    _throttledFrames++;
+}
+
+void WorkloadGovernor::logCounters() const {
+    okay::Engine.logger.info(
+        "workload [{}]: table ran {} shed {}, animations ran {} shed {}, "
+        "diagnostics ran {} shed {}, {} throttled frames",
+        driveStateName(_state),
+        runCount(WorkStage::SIGNAL_TABLE),
+        shedCount(WorkStage::SIGNAL_TABLE),
+        runCount(WorkStage::ANIMATIONS),
+        shedCount(WorkStage::ANIMATIONS),
+        runCount(WorkStage::DIAGNOSTICS),
+        shedCount(WorkStage::DIAGNOSTICS),
+        _throttledFrames);
+}
+
+}  // namespace dash::perf
@@ -0,0 +1,94 @@
+#ifndef __WORKLOAD_POLICY_HPP__
+#define __WORKLOAD_POLICY_HPP__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace dash::perf {
+
+// ECU_Drive_Status::Drive_State
+enum class DriveState : uint8_t {
+    IDLE = 0,
+    PRECHARGE = 1,
+    NEUTRAL = 2,
+    DRIVE = 3,
+    FAULT = 4,
+    COUNT
+};
+
+// non-critical work that can be shed. CAN, bound lights (shift lights, faults) and input always
+// run every iteration and are not in the table.
+enum class WorkStage : uint8_t {
+    SIGNAL_TABLE,  // full terminal redraw
+    ANIMATIONS,    // ambient LED animations on unbound bars
+    DIAGNOSTICS,   // low-priority reporting and logging
+    COUNT
+};
+
+static constexpr size_t NUM_DRIVE_STATES = static_cast<size_t>(DriveState::COUNT);
+static constexpr size_t NUM_WORK_STAGES = static_cast<size_t>(WorkStage::COUNT);
+
+// rates in Hz, 0 means every frame. loopHz caps how often the main loop iterates while parked,
+// which is what keeps the sealed front box cool. When the main loop is the one ticking the bus
+// it can't drop below BUS_LOOP_HZ, as it's also what drains the MCP2515's two RX buffers.
+struct StagePolicy {
+    float loopHz;
+    std::array<float, NUM_WORK_STAGES> stageHz;
+};
+
+using WorkloadPolicyTable = std::array<StagePolicy, NUM_DRIVE_STATES>;
+
+// clang-format off
+static constexpr WorkloadPolicyTable DEFAULT_WORKLOAD_POLICY = {{
+    //  loop    table  animations  diagnostics
+    { 25.0f, {{ 5.0f, 20.0f,      1.0f }} },   // IDLE
+    { 25.0f, {{ 5.0f, 20.0f,      1.0f }} },   // PRECHARGE
+    {  0.0f, {{20.0f,  0.0f,      1.0f }} },   // NEUTRAL
+    {  0.0f, {{ 5.0f,  0.0f,      0.2f }} },   // DRIVE
+    {  0.0f, {{20.0f,  0.0f,      1.0f }} },   // FAULT
+}};
+// clang-format on
+
+class WorkloadGovernor {
+   public:
+    static constexpr float BUS_LOOP_HZ = 1000.0f;
+
+    explicit WorkloadGovernor(const WorkloadPolicyTable& table = DEFAULT_WORKLOAD_POLICY);
+
+    // raw Drive_State value; anything out of range is treated as FAULT
+    void setDriveState(uint8_t rawState);
+    DriveState driveState() const { return _state; }
+
+    // true if the stage is due this frame, otherwise counts it as shed
+    bool shouldRun(WorkStage stage, uint64_t nowNs);
+
+    // false once the bus is ticked on a thread of its own, which lets a parked loop slow down
+    void setBusOnLoop(bool busOnLoop) { _busOnLoop = busOnLoop; }
+
+    // sleeps out the rest of the frame when the current state caps the loop rate
+    void throttleLoop(uint64_t frameStartNs);
+
+    uint64_t shedCount(WorkStage stage) const { return _shed[static_cast<size_t>(stage)]; }
+    uint64_t runCount(WorkStage stage) const { return _runs[static_cast<size_t>(stage)]; }
+    uint64_t throttledFrames() const { return _throttledFrames; }
+
+    void logCounters() const;
+
+   private:
+    const StagePolicy& policy() const { return _table[static_cast<size_t>(_state)]; }
+
+    WorkloadPolicyTable _table;
+    DriveState _state = DriveState::IDLE;
+    std::array<uint64_t, NUM_WORK_STAGES> _lastRunNs{};
+    std::array<uint64_t, NUM_WORK_STAGES> _shed{};
+    std::array<uint64_t, NUM_WORK_STAGES> _runs{};
+    uint64_t _throttledFrames = 0;
+    bool _busOnLoop = true;
+};
+
+const char* driveStateName(DriveState state);
+
+}  // namespace dash::perf
+
+#endif  // __WORKLOAD_POLICY_HPP__
@@ -7,25 +7,23 @@ Button::Button(uint8_t gpioPin) :
     _gpio(std::make_unique<GPIO>(gpioPin, false))
 {
     InputManager::instance().registerButton(_buttonID);
+    _gpio->setDebouncePeriod(DEBOUNCE_PERIOD);
 
-    _gpio->attachInterrupt([id = _buttonID](){
-        InputManager::instance().executeUpCallbacks(id);
-    }, GPIO::EdgeType::FALLING);
-
-    _gpio->attachInterrupt([id = _buttonID](){
-        InputManager::instance().executeDownCallbacks(id);
-    }, GPIO::EdgeType::RISING);
+    // rising is down and falling is up, InputManager decides which from the event
+    _gpio->attachInterrupt(
+        EdgeCallback::bind<&InputManager::pushEvent>(&InputManager::instance()),
+        GPIO::EdgeType::BOTH);
 }
 
 Button::~Button(){
     InputManager::instance().unregisterButton(_buttonID);
 }
 
-void Button::onDown(std::function<void()> callback){
+void Button::onDown(Callback callback){
     InputManager::instance().attachDownCallback(_buttonID, std::move(callback));
 }
 
-void Button::onUp(std::function<void()> callback){
+void Button::onUp(Callback callback){
     InputManager::instance().attachUpCallback(_buttonID, std::move(callback));
 }
 
@@ -0,0 +1,70 @@
+#ifndef __COLOR_HPP__
+#define __COLOR_HPP__
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace dash::platform {
+
+// 8 bits per channel packed as 0xAABBGGRR, so two colors compare as a single word. Alpha is the
+// pixel's brightness, it's premultiplied in when the color is encoded for the strip.
+struct Color {
+    uint32_t packed = 0;
+
+    static constexpr Color rgba(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
+        return Color{static_cast<uint32_t>(a) << 24 | static_cast<uint32_t>(b) << 16 |
+                     static_cast<uint32_t>(g) << 8 | static_cast<uint32_t>(r)};
+    }
+
+    // float edge for animation code, components are clamped to [0, 1]
+    static Color fromVec4(const glm::vec4& color) {
+        glm::vec4 scaled = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+        return rgba(static_cast<uint8_t>(scaled.r),
+                    static_cast<uint8_t>(scaled.g),
+                    static_cast<uint8_t>(scaled.b),
+                    static_cast<uint8_t>(scaled.a));
+    }
+
+    constexpr uint8_t r() const { return static_cast<uint8_t>(packed); }
+    constexpr uint8_t g() const { return static_cast<uint8_t>(packed >> 8); }
+    constexpr uint8_t b() const { return static_cast<uint8_t>(packed >> 16); }
+    constexpr uint8_t a() const { return static_cast<uint8_t>(packed >> 24); }
+
+    glm::vec4 toVec4() const { return glm::vec4(r(), g(), b(), a()) / 255.0f; }
+
+    constexpr bool operator==(const Color& other) const { return packed == other.packed; }
+    constexpr bool operator!=(const Color& other) const { return packed != other.packed; }
+};
+
+static constexpr float LED_GAMMA = 2.2f;
+
+// perceptual -> linear PWM duty, built once at startup
+inline const std::array<uint8_t, 256> GAMMA_LUT = [] {
+    std::array<uint8_t, 256> lut{};
+    for (int i = 0; i < 256; i++) {
+        lut[i] = static_cast<uint8_t>(std::pow(i / 255.0f, LED_GAMMA) * 255.0f + 0.5f);
+    }
+    return lut;
+}();
+
+// exact round(x * y / 255) for 8 bit x, y without a divide
+constexpr uint8_t mulDiv255(uint32_t x, uint32_t y) {
+    uint32_t product = x * y + 128;
+    return static_cast<uint8_t>((product + (product >> 8)) >> 8);
+}
+
+// strip word for a color: brightness premultiplied, then gamma corrected, W carries alpha²
+inline uint32_t encodePixel(Color color) {
+    uint8_t a = color.a();
+    return static_cast<uint32_t>(GAMMA_LUT[mulDiv255(a, a)]) << 24 |
+           static_cast<uint32_t>(GAMMA_LUT[mulDiv255(color.b(), a)]) << 16 |
+           static_cast<uint32_t>(GAMMA_LUT[mulDiv255(color.g(), a)]) << 8 |
+           static_cast<uint32_t>(GAMMA_LUT[mulDiv255(color.r(), a)]);
+}
+
+}  // namespace dash::platform
+
+#endif  // __COLOR_HPP__
@@ -0,0 +1,61 @@
+#ifndef __DELEGATE_HPP__
+#define __DELEGATE_HPP__
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace dash::platform {
+
+template <typename Signature, size_t INLINE_BYTES = 2 * sizeof(void*)>
+class Delegate;
+
+// Non-allocating callback. The callable is stored inline, so it has to fit in INLINE_BYTES and be
+// trivially copyable: function pointers, and lambdas capturing pointers, references or plain
+// values. Anything bigger, or owning a resource, fails to compile instead of going to the heap.
+// Calling it is one indirect call, and copying it is a memcpy.
+template <typename R, typename... Args, size_t INLINE_BYTES>
+class Delegate<R(Args...), INLINE_BYTES> {
+   public:
+    Delegate() = default;
+    Delegate(std::nullptr_t) {}
+
+    template <typename F,
+              typename Fn = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same_v<Fn, Delegate> &&
+                                          std::is_invocable_r_v<R, const Fn&, Args...>>>
+    Delegate(F&& fn) {
+        static_assert(sizeof(Fn) <= INLINE_BYTES, "callable is too big for the delegate");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t), "callable is over-aligned");
+        static_assert(std::is_trivially_copyable_v<Fn> && std::is_trivially_destructible_v<Fn>,
+                      "delegates only hold trivially copyable callables");
+
+        ::new (static_cast<void*>(_storage)) Fn(std::forward<F>(fn));
+        _invoke = [](const void* storage, Args... args) -> R {
+            return (*std::launder(static_cast<const Fn*>(storage)))(std::forward<Args>(args)...);
+        };
+    }
+
+    // a delegate calling METHOD on object, without a lambda in between
+    template <auto METHOD, typename T>
+    static Delegate bind(T* object) {
+        return Delegate([object](Args... args) -> R {
+            return (object->*METHOD)(std::forward<Args>(args)...);
+        });
+    }
+
+    R operator()(Args... args) const {
+        return _invoke(_storage, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const { return _invoke != nullptr; }
+
+   private:
+    alignas(std::max_align_t) unsigned char _storage[INLINE_BYTES]{};
+    R (*_invoke)(const void*, Args...) = nullptr;
+};
+
+}  // namespace dash::platform
+
+#endif  // __DELEGATE_HPP__
@@ -12,14 +12,14 @@ Encoder::Encoder(uint8_t leftPin, uint8_t rightPin) :
     _rightGPIO(std::make_unique<GPIO>(rightPin, false))
 {
     InputManager::instance().registerEncoder(_encoderID, leftPin, rightPin);
+    _leftGPIO->setDebouncePeriod(DEBOUNCE_PERIOD);
+    _rightGPIO->setDebouncePeriod(DEBOUNCE_PERIOD);
 
-    _leftGPIO->attachInterrupt([id = _encoderID](){
-        InputManager::instance().onEncoderEdge(id);
-    }, GPIO::EdgeType::BOTH);
-
-    _rightGPIO->attachInterrupt([id = _encoderID](){
-        InputManager::instance().onEncoderEdge(id);
-    }, GPIO::EdgeType::BOTH);
+    // both pins go straight into the event ring, InputManager decodes the quadrature
+    EdgeCallback pushEvent =
+        EdgeCallback::bind<&InputManager::pushEvent>(&InputManager::instance());
+    _leftGPIO->attachInterrupt(pushEvent, GPIO::EdgeType::BOTH);
+    _rightGPIO->attachInterrupt(pushEvent, GPIO::EdgeType::BOTH);
 
 }
 
@@ -27,14 +27,22 @@ Encoder::~Encoder(){
     InputManager::instance().unregisterEncoder(_encoderID);
 }
 
-void Encoder::onRight(std::function<void()> callback){
+void Encoder::onRight(Callback callback){
     InputManager::instance().attachRightCallback(_encoderID, std::move(callback));
 }
 
-void Encoder::onLeft(std::function<void()> callback){
+void Encoder::onLeft(Callback callback){
     InputManager::instance().attachLeftCallback(_encoderID, std::move(callback));
 }
 
+void Encoder::onDelta(DeltaCallback callback){
+    InputManager::instance().attachDeltaCallback(_encoderID, std::move(callback));
+}
+
+void Encoder::setAcceleration(const EncoderAcceleration& acceleration){
+    InputManager::instance().setEncoderAcceleration(_encoderID, acceleration);
+}
+
 bool Encoder::isIdle(){
     return InputManager::instance().isIdle(_encoderID);
 }
@@ -47,4 +55,12 @@ bool Encoder::isLeftThisFrame(){
     return InputManager::instance().isLeftThisFrame(_encoderID);
 }
 
+int Encoder::deltaThisFrame(){
+    return InputManager::instance().deltaThisFrame(_encoderID);
+}
+
+float Encoder::velocity(){
+    return InputManager::instance().encoderVelocity(_encoderID);
+}
+
 }
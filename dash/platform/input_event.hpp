@@ -0,0 +1,66 @@
+#ifndef __INPUT_EVENT_HPP__
+#define __INPUT_EVENT_HPP__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace dash::platform {
+
+// One edge on an input pin as the kernel saw it. The timestamp is CLOCK_MONOTONIC (the same base
+// as perf::monotonicNs), the sequence number counts edges across the whole line request.
+struct InputEvent {
+  enum class Edge : uint8_t {
+    RISING,
+    FALLING
+  };
+
+  uint8_t pin = 0;
+  Edge edge = Edge::RISING;
+  uint64_t timestampNs = 0;
+  uint64_t sequence = 0;
+};
+
+// Fixed-capacity FIFO of input events, drained in arrival order. A push into a full ring drops
+// the new event and counts it, the events already queued are kept.
+template <size_t CAPACITY>
+class InputEventRing {
+public:
+  bool push(const InputEvent& event) {
+    if (_count == CAPACITY) {
+      _overflows++;
+      return false;
+    }
+
+    _events[(_head + _count) % CAPACITY] = event;
+    _count++;
+    return true;
+  }
+
+  bool pop(InputEvent& out) {
+    if (_count == 0) {
+      return false;
+    }
+
+    out = _events[_head];
+    _head = (_head + 1) % CAPACITY;
+    _count--;
+    return true;
+  }
+
+  size_t size() const { return _count; }
+  static constexpr size_t capacity() { return CAPACITY; }
+
+  // events dropped since construction
+  uint32_t overflowCount() const { return _overflows; }
+
+private:
+  std::array<InputEvent, CAPACITY> _events{};
+  size_t _head = 0;
+  size_t _count = 0;
+  uint32_t _overflows = 0;
+};
+
+} // namespace dash::platform
+
+#endif // __INPUT_EVENT_HPP__
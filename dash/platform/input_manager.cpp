@@ -0,0 +1,345 @@
+#include <platform/platform.hpp>
+#include <okay/core/okay.hpp>
+#include <perf/clock.hpp>
+
+namespace dash::platform {
+
+InputManager::InputManager() {
+    _pinEncoder.fill(-1);
+}
+
+InputManager& InputManager::instance(){
+    static InputManager instance;
+    return instance;
+}
+
+int InputManager::encoderSlot(uint16_t encoderID) const {
+    for (size_t slot = 0; slot < MAX_ENCODERS; slot++) {
+        if (_encoders[slot].used && _encoders[slot].id == encoderID) {
+            return static_cast<int>(slot);
+        }
+    }
+    return -1;
+}
+
+void InputManager::registerButton(uint8_t buttonID){
+    if (buttonID >= MAX_PINS) {
+        okay::Engine.logger.error("Button pin {} is out of range", buttonID);
+        return;
+    }
+
+    uint32_t bit = pinBit(buttonID);
+    _buttonPins |= bit;
+    _downPins &= ~bit;
+    _downThisFrame &= ~bit;
+    _upThisFrame &= ~bit;
+}
+
+void InputManager::unregisterButton(uint8_t buttonID){
+    if (buttonID >= MAX_PINS) return;
+
+    _buttonPins &= ~pinBit(buttonID);
+    _downCallbacks[buttonID].clear();
+    _upCallbacks[buttonID].clear();
+}
+
+void InputManager::attachDownCallback(uint8_t buttonID, Callback callback){
+    if (buttonID >= MAX_PINS || !_downCallbacks[buttonID].add(std::move(callback))) {
+        okay::Engine.logger.error("Unable to attach a down callback to button {}", buttonID);
+    }
+}
+
+void InputManager::attachUpCallback(uint8_t buttonID, Callback callback){
+    if (buttonID >= MAX_PINS || !_upCallbacks[buttonID].add(std::move(callback))) {
+        okay::Engine.logger.error("Unable to attach an up callback to button {}", buttonID);
+    }
+}
+
+void InputManager::executeDownCallbacks(uint8_t buttonID){
+    if (buttonID < MAX_PINS) {
+        _downCallbacks[buttonID].run();
+    }
+}
+
+void InputManager::executeUpCallbacks(uint8_t buttonID){
+    if (buttonID < MAX_PINS) {
+        _upCallbacks[buttonID].run();
+    }
+}
+
+// unregistered or out of range buttons read as up, the pin bits are simply never set for them
+bool InputManager::isDownThisFrame(uint8_t buttonID){
+    return buttonID < MAX_PINS && (_downThisFrame & pinBit(buttonID));
+}
+
+bool InputManager::isUpThisFrame(uint8_t buttonID){
+    return buttonID < MAX_PINS && (_upThisFrame & pinBit(buttonID));
+}
+
+// a button that went down this frame reports DOWN_THIS_FRAME rather than DOWN, as before
+bool InputManager::isDown(uint8_t buttonID){
+    return buttonID < MAX_PINS && (_downPins & ~_downThisFrame & pinBit(buttonID));
+}
+
+void InputManager::registerEncoder(uint16_t encoderID, uint8_t pinA, uint8_t pinB){
+    if (pinA >= MAX_PINS || pinB >= MAX_PINS) {
+        okay::Engine.logger.error("Encoder pins {} and {} are out of range", pinA, pinB);
+        return;
+    }
+
+    int slot = encoderSlot(encoderID);
+    for (size_t i = 0; slot < 0 && i < MAX_ENCODERS; i++) {
+        if (!_encoders[i].used) {
+            slot = static_cast<int>(i);
+        }
+    }
+
+    if (slot < 0) {
+        okay::Engine.logger.error("No free encoder slot for encoder {:#06x}", encoderID);
+        return;
+    }
+
+    _encoders[slot] = EncoderRuntime{.id = encoderID, .pinA = pinA, .pinB = pinB, .used = true};
+    _pinEncoder[pinA] = static_cast<int8_t>(slot);
+    _pinEncoder[pinB] = static_cast<int8_t>(slot);
+    _encoderPins |= pinBit(pinA) | pinBit(pinB);
+}
+
+void InputManager::unregisterEncoder(uint16_t encoderID){
+    int slot = encoderSlot(encoderID);
+    if (slot < 0) return;
+
+    EncoderRuntime& e = _encoders[slot];
+    _pinEncoder[e.pinA] = -1;
+    _pinEncoder[e.pinB] = -1;
+    _encoderPins &= ~(pinBit(e.pinA) | pinBit(e.pinB));
+    e.left.clear();
+    e.right.clear();
+    e.used = false;
+
+    uint8_t bit = static_cast<uint8_t>(1u << slot);
+    _leftThisFrame &= ~bit;
+    _rightThisFrame &= ~bit;
+}
+
+void InputManager::attachLeftCallback(uint16_t encoderID, Callback callback) {
+  int slot = encoderSlot(encoderID);
+  if (slot < 0 || !_encoders[slot].left.add(std::move(callback))) {
+    okay::Engine.logger.error("Unable to attach a left callback to encoder {:#06x}", encoderID);
+  }
+}
+
+void InputManager::attachRightCallback(uint16_t encoderID, Callback callback) {
+  int slot = encoderSlot(encoderID);
+  if (slot < 0 || !_encoders[slot].right.add(std::move(callback))) {
+    okay::Engine.logger.error("Unable to attach a right callback to encoder {:#06x}", encoderID);
+  }
+}
+
+void InputManager::executeLeftCallbacks(uint16_t encoderID) {
+  int slot = encoderSlot(encoderID);
+  if (slot >= 0) _encoders[slot].left.run();
+}
+
+void InputManager::executeRightCallbacks(uint16_t encoderID) {
+  int slot = encoderSlot(encoderID);
+  if (slot >= 0) _encoders[slot].right.run();
+}
+
+void InputManager::attachDeltaCallback(uint16_t encoderID, DeltaCallback callback) {
+  int slot = encoderSlot(encoderID);
+  if (slot < 0 || !_encoders[slot].delta.add(std::move(callback))) {
+    okay::Engine.logger.error("Unable to attach a delta callback to encoder {:#06x}", encoderID);
+  }
+}
+
+void InputManager::setEncoderAcceleration(uint16_t encoderID,
+                                          const EncoderAcceleration& acceleration) {
+  int slot = encoderSlot(encoderID);
+  if (slot >= 0) _encoders[slot].acceleration = acceleration;
+}
+
+bool InputManager::isLeftThisFrame(uint16_t encoderID) const {
+  int slot = encoderSlot(encoderID);
+  return slot >= 0 && (_leftThisFrame & (1u << slot));
+}
+
+bool InputManager::isRightThisFrame(uint16_t encoderID) const {
+  int slot = encoderSlot(encoderID);
+  return slot >= 0 && (_rightThisFrame & (1u << slot));
+}
+
+bool InputManager::isIdle(uint16_t encoderID) const {
+  int slot = encoderSlot(encoderID);
+  return slot >= 0 && !((_leftThisFrame | _rightThisFrame) & (1u << slot));
+}
+
+int InputManager::deltaThisFrame(uint16_t encoderID) const {
+  int slot = encoderSlot(encoderID);
+  return slot >= 0 ? _encoders[slot].frameDelta : 0;
+}
+
+float InputManager::encoderVelocity(uint16_t encoderID) const {
+  int slot = encoderSlot(encoderID);
+  if (slot < 0) return 0.0f;
+
+  const EncoderRuntime& e = _encoders[slot];
+  if (dash::perf::monotonicNs() - e.lastDetentNs > ENCODER_IDLE_NS) return 0.0f;
+  return e.velocity;
+}
+
+bool InputManager::encoderAt(size_t slot, uint16_t& encoderID, uint8_t& pinA,
+                             uint8_t& pinB) const {
+  if (slot >= MAX_ENCODERS || !_encoders[slot].used) return false;
+
+  encoderID = _encoders[slot].id;
+  pinA = _encoders[slot].pinA;
+  pinB = _encoders[slot].pinB;
+  return true;
+}
+
+void InputManager::pushEvent(const InputEvent& event) {
+    _events.push(event);
+}
+
+std::span<const InputEvent> InputManager::frameEvents() const {
+    return {_frameEvents.data(), _frameEventCount};
+}
+
+uint32_t InputManager::overflowCount() const {
+    return _events.overflowCount();
+}
+
+// the level is taken from the edge rather than read back, so a press and release that both
+// land within one frame still come out as a down followed by an up
+void InputManager::onButtonEdge(uint8_t buttonID, const InputEvent& event) {
+  uint32_t bit = pinBit(buttonID);
+  bool down = _downPins & bit;
+
+  if (event.edge == InputEvent::Edge::RISING && !down) {
+    _downPins |= bit;
+    _downThisFrame |= bit;
+    _upThisFrame &= ~bit;
+    _downCallbacks[buttonID].run();
+  } else if (event.edge == InputEvent::Edge::FALLING && down) {
+    _downPins &= ~bit;
+    _upThisFrame |= bit;
+    _downThisFrame &= ~bit;
+    _upCallbacks[buttonID].run();
+  }
+}
+
+void InputManager::onEncoderEdge(size_t slot, const InputEvent& event) {
+  EncoderRuntime& e = _encoders[slot];
+
+  const uint8_t bit = event.pin == e.pinA ? 0b10 : 0b01;
+
+  // the pins are only read once, after that their levels follow from the edges, in the order
+  // the kernel saw them. the pin that just moved is taken from the edge, the read may be late
+  if (!e.initialized) {
+    uint32_t pins = 0;
+    readInputPins(pinBit(e.pinA) | pinBit(e.pinB), pins);
+
+    uint8_t levels = (static_cast<uint8_t>((pins & pinBit(e.pinA)) != 0) << 1) |
+                     static_cast<uint8_t>((pins & pinBit(e.pinB)) != 0);
+    e.prevAB = event.edge == InputEvent::Edge::RISING ? static_cast<uint8_t>(levels | bit)
+                                                      : static_cast<uint8_t>(levels & ~bit);
+    e.initialized = true;
+    return;
+  }
+
+  const uint8_t currAB = event.edge == InputEvent::Edge::RISING
+                             ? static_cast<uint8_t>(e.prevAB | bit)
+                             : static_cast<uint8_t>(e.prevAB & ~bit);
+
+  static constexpr int8_t kQuad[16] = {
+      0, -1, +1,  0,
+      +1, 0,  0, -1,
+      -1, 0,  0, +1,
+      0, +1, -1,  0
+  };
+
+  const uint8_t idx = static_cast<uint8_t>((e.prevAB << 2) | currAB);
+  e.accum += kQuad[idx];
+  e.prevAB = currAB;
+
+  const uint8_t slotBit = static_cast<uint8_t>(1u << slot);
+  if (e.accum >= 4) {
+    _rightThisFrame |= slotBit;
+    _leftThisFrame &= ~slotBit;
+    e.right.run();
+    onDetent(e, +1, event.timestampNs);
+    e.accum = 0;
+  } else if (e.accum <= -4) {
+    _leftThisFrame |= slotBit;
+    _rightThisFrame &= ~slotBit;
+    e.left.run();
+    onDetent(e, -1, event.timestampNs);
+    e.accum = 0;
+  }
+}
+
+// Velocity comes from the kernel timestamps of consecutive detents, so it's exact no matter how
+// many detents land in one frame. It's smoothed over the last few detents, and a pause or a change
+// of direction starts over from one step per detent.
+void InputManager::onDetent(EncoderRuntime& e, int8_t direction, uint64_t timestampNs) {
+  uint64_t gapNs = timestampNs - e.lastDetentNs;
+  if (e.lastDetentNs == 0 || direction != e.lastDirection || gapNs > ENCODER_IDLE_NS) {
+    e.velocity = 0.0f;
+  } else if (gapNs > 0) {
+    float instant = 1e9f / static_cast<float>(gapNs);
+    e.velocity = e.velocity == 0.0f ? instant : 0.5f * (e.velocity + instant);
+  }
+
+  e.lastDetentNs = timestampNs;
+  e.lastDirection = direction;
+  e.frameDelta += direction * e.acceleration.stepsFor(e.velocity);
+}
+
+void InputManager::tick(){
+    beginFrame();
+    pollInputEvents();
+    endFrame();
+}
+
+void InputManager::beginFrame(){
+    // the THIS_FRAME states only last the frame after the edge that set them
+    _downThisFrame = 0;
+    _upThisFrame = 0;
+    _leftThisFrame = 0;
+    _rightThisFrame = 0;
+    for (EncoderRuntime& e : _encoders) {
+        e.frameDelta = 0;
+    }
+}
+
+void InputManager::endFrame(){
+    _frameEventCount = 0;
+    InputEvent event;
+    while (_events.pop(event)) {
+        if (event.pin >= MAX_PINS) continue;
+        _frameEvents[_frameEventCount++] = event;
+
+        uint32_t bit = pinBit(event.pin);
+        if (_buttonPins & bit) {
+            onButtonEdge(event.pin, event);
+        } else if (_encoderPins & bit) {
+            onEncoderEdge(static_cast<size_t>(_pinEncoder[event.pin]), event);
+        }
+    }
+
+    // every detent of the frame, accelerated, in one call per encoder
+    for (const EncoderRuntime& e : _encoders) {
+        if (e.used && e.frameDelta != 0) {
+            e.delta.run(e.frameDelta);
+        }
+    }
+
+    if (_events.overflowCount() != _reportedOverflows) {
+        okay::Engine.logger.warn("Input event ring overflowed, {} edges dropped so far",
+                                 _events.overflowCount());
+        _reportedOverflows = _events.overflowCount();
+    }
+}
+
+}
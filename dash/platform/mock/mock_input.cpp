@@ -0,0 +1,240 @@
+#include "platform/mock/mock_input.hpp"
+#include <perf/clock.hpp>
+#include <okay/core/okay.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <imgui.h>
+
+namespace dash::platform::mock {
+
+static constexpr uint8_t MAX_PINS = 28;
+
+struct PendingChange {
+  uint64_t timestampNs;
+  uint8_t pin;
+  bool high;
+};
+
+struct PinCallbacks {
+  EdgeCallback rising;
+  EdgeCallback falling;
+};
+
+// delivered levels, and where each pin ends up once everything pending is delivered
+static std::array<bool, MAX_PINS> s_levels{};
+static std::array<bool, MAX_PINS> s_projected{};
+static std::array<PinCallbacks, MAX_PINS> s_callbacks{};
+
+// kept sorted by timestamp, changes with the same timestamp stay in injection order
+static std::vector<PendingChange> s_pending;
+static uint64_t s_sequence = 0;
+
+void injectLevel(uint8_t pin, bool high, uint64_t timestampNs) {
+  if (pin >= MAX_PINS) return;
+
+  auto at = std::upper_bound(s_pending.begin(), s_pending.end(), timestampNs,
+                             [](uint64_t ts, const PendingChange& change) {
+                               return ts < change.timestampNs;
+                             });
+  s_pending.insert(at, PendingChange{timestampNs, pin, high});
+  s_projected[pin] = high;
+}
+
+void injectDetent(uint8_t pinA, uint8_t pinB, int direction, uint64_t startNs, uint64_t periodNs) {
+  if (pinA >= MAX_PINS || pinB >= MAX_PINS) return;
+
+  // a right detent toggles A, B, A, B, a left one B, A, B, A
+  const uint8_t first = direction > 0 ? pinA : pinB;
+  const uint8_t second = direction > 0 ? pinB : pinA;
+  for (int i = 0; i < 4; i++) {
+    uint8_t pin = i % 2 == 0 ? first : second;
+    injectLevel(pin, !s_projected[pin], startNs + periodNs * i / 4);
+  }
+}
+
+void attachInterrupt(uint8_t pin, EdgeCallback callback,
+                     GPIO::EdgeType edge) {
+  if (pin >= MAX_PINS) return;
+
+  if (edge == GPIO::EdgeType::RISING || edge == GPIO::EdgeType::BOTH) {
+    s_callbacks[pin].rising = callback;
+  }
+  if (edge == GPIO::EdgeType::FALLING || edge == GPIO::EdgeType::BOTH) {
+    s_callbacks[pin].falling = callback;
+  }
+}
+
+bool readPin(uint8_t pin) {
+  return pin < MAX_PINS && s_levels[pin];
+}
+
+bool loadScript(const char* path) {
+  FILE* file = std::fopen(path, "r");
+  if (file == nullptr) {
+    okay::Engine.logger.error("Unable to open input script {}", path);
+    return false;
+  }
+
+  const uint64_t startNs = dash::perf::monotonicNs();
+  char line[128];
+  int lineNumber = 0;
+  size_t changes = 0;
+
+  while (std::fgets(line, sizeof(line), file) != nullptr) {
+    lineNumber++;
+    if (line[0] == '#' || line[0] == '\n') continue;
+
+    unsigned long timeMs = 0;
+    char action[16] = {};
+    int a = -1;
+    int b = -1;
+    int fields = std::sscanf(line, "%lu %15s %d %d", &timeMs, action, &a, &b);
+    uint64_t timestampNs = startNs + static_cast<uint64_t>(timeMs) * 1'000'000ULL;
+
+    if (fields >= 3 && std::strcmp(action, "press") == 0) {
+      injectLevel(static_cast<uint8_t>(a), true, timestampNs);
+    } else if (fields >= 3 && std::strcmp(action, "release") == 0) {
+      injectLevel(static_cast<uint8_t>(a), false, timestampNs);
+    } else if (fields == 4 && std::strcmp(action, "level") == 0) {
+      injectLevel(static_cast<uint8_t>(a), b != 0, timestampNs);
+    } else if (fields == 4 && std::strcmp(action, "right") == 0) {
+      injectDetent(static_cast<uint8_t>(a), static_cast<uint8_t>(b), +1, timestampNs, 4'000'000);
+    } else if (fields == 4 && std::strcmp(action, "left") == 0) {
+      injectDetent(static_cast<uint8_t>(a), static_cast<uint8_t>(b), -1, timestampNs, 4'000'000);
+    } else {
+      okay::Engine.logger.warn("{}:{}: unable to parse input script line", path, lineNumber);
+      continue;
+    }
+    changes++;
+  }
+
+  std::fclose(file);
+  okay::Engine.logger.info("Loaded {} input changes from {}", changes, path);
+  return true;
+}
+
+void configureFromEnvironment() {
+  const char* path = std::getenv("DASH_MOCK_INPUT_SCRIPT");
+  if (path != nullptr && path[0] != '\0') {
+    loadScript(path);
+  }
+}
+
+// the first few buttons, in pin order, are also on the keyboard
+static constexpr std::array<ImGuiKey, 4> BUTTON_KEYS = {
+    ImGuiKey_Enter, ImGuiKey_Space, ImGuiKey_UpArrow, ImGuiKey_DownArrow};
+static constexpr std::array<const char*, 4> BUTTON_KEY_NAMES = {"Enter", "Space", "Up", "Down"};
+static constexpr uint64_t DETENT_NS = 4'000'000;
+
+void drawInputWindow() {
+  InputManager& input = InputManager::instance();
+  const uint64_t nowNs = dash::perf::monotonicNs();
+
+  ImGui::Begin("Inputs");
+
+  size_t keyIndex = 0;
+  uint32_t buttons = input.buttonPinMask();
+  for (uint8_t pin = 0; pin < MAX_PINS; pin++) {
+    if (!(buttons & (1u << pin))) continue;
+
+    char label[32];
+    std::snprintf(label, sizeof(label), "GPIO%u", pin);
+    ImGui::Button(label);
+    bool pressed = ImGui::IsItemActivated();
+    bool released = ImGui::IsItemDeactivated();
+
+    if (keyIndex < BUTTON_KEYS.size()) {
+      pressed |= ImGui::IsKeyPressed(BUTTON_KEYS[keyIndex], false);
+      released |= ImGui::IsKeyReleased(BUTTON_KEYS[keyIndex]);
+      ImGui::SameLine();
+      ImGui::Text("[%s]", BUTTON_KEY_NAMES[keyIndex]);
+      keyIndex++;
+    }
+
+    if (pressed) injectLevel(pin, true, nowNs);
+    if (released) injectLevel(pin, false, nowNs);
+
+    ImGui::SameLine();
+    ImGui::Text("%s", input.isDown(pin) || input.isDownThisFrame(pin) ? "down" : "up");
+  }
+
+  for (size_t slot = 0; slot < InputManager::MAX_ENCODERS; slot++) {
+    uint16_t encoderID;
+    uint8_t pinA;
+    uint8_t pinB;
+    if (!input.encoderAt(slot, encoderID, pinA, pinB)) continue;
+
+    ImGui::Separator();
+    ImGui::Text("Encoder GPIO%u/GPIO%u", pinA, pinB);
+
+    char label[32];
+    std::snprintf(label, sizeof(label), "<##%u", encoderID);
+    bool left = ImGui::Button(label);
+    ImGui::SameLine();
+    std::snprintf(label, sizeof(label), ">##%u", encoderID);
+    bool right = ImGui::Button(label);
+
+    // the arrow keys turn the first encoder, held down they repeat like a fast spin
+    if (slot == 0) {
+      left |= ImGui::IsKeyPressed(ImGuiKey_LeftArrow, true);
+      right |= ImGui::IsKeyPressed(ImGuiKey_RightArrow, true);
+      ImGui::SameLine();
+      ImGui::Text("[Left/Right]");
+    }
+
+    if (left) injectDetent(pinA, pinB, -1, nowNs, DETENT_NS);
+    if (right) injectDetent(pinA, pinB, +1, nowNs, DETENT_NS);
+
+    ImGui::Text("delta %d, %.1f detents/s",
+                input.deltaThisFrame(encoderID),
+                input.encoderVelocity(encoderID));
+  }
+
+  ImGui::Separator();
+  ImGui::Text("%zu pending, %u overflowed", s_pending.size(), input.overflowCount());
+  ImGui::End();
+}
+
+}  // namespace dash::platform::mock
+
+namespace dash::platform {
+
+void pollInputEvents() {
+  const uint64_t nowNs = dash::perf::monotonicNs();
+
+  size_t delivered = 0;
+  for (; delivered < mock::s_pending.size(); delivered++) {
+    const mock::PendingChange& change = mock::s_pending[delivered];
+    if (change.timestampNs > nowNs) break;
+    if (mock::s_levels[change.pin] == change.high) continue;
+    mock::s_levels[change.pin] = change.high;
+
+    InputEvent event{
+        .pin = change.pin,
+        .edge = change.high ? InputEvent::Edge::RISING : InputEvent::Edge::FALLING,
+        .timestampNs = change.timestampNs,
+        .sequence = ++mock::s_sequence,
+    };
+
+    const auto& callback = change.high ? mock::s_callbacks[change.pin].rising
+                                       : mock::s_callbacks[change.pin].falling;
+    if (callback) callback(event);
+  }
+
+  mock::s_pending.erase(mock::s_pending.begin(), mock::s_pending.begin() + delivered);
+}
+
+bool readInputPins(uint32_t mask, uint32_t& levels) {
+  levels = 0;
+  for (uint8_t pin = 0; pin < mock::MAX_PINS; pin++) {
+    if ((mask & (1u << pin)) && mock::s_levels[pin]) levels |= 1u << pin;
+  }
+  return true;
+}
+
+}  // namespace dash::platform
@@ -0,0 +1,44 @@
+#ifndef __MOCK_INPUT_HPP__
+#define __MOCK_INPUT_HPP__
+
+#include "platform/platform.hpp"
+
+#include <cstdint>
+#include <functional>
+
+// Input source for the mock platform. The mock GPIO pins hold levels that are driven by injected
+// changes, from the "Inputs" ImGui window, the keyboard or a script file. Each change is delivered
+// by pollInputEvents() once its timestamp has passed, as an edge through the pin's interrupt
+// callbacks, exactly like an edge read from the gpiochip on the car.
+namespace dash::platform::mock {
+
+// schedules pin going to level high/low at timestampNs (CLOCK_MONOTONIC), a no-op if it's already
+// there by then
+void injectLevel(uint8_t pin, bool high, uint64_t timestampNs);
+
+// one quadrature detent on an encoder's pins, four edges spread over periodNs, +1 is right
+void injectDetent(uint8_t pinA, uint8_t pinB, int direction, uint64_t startNs, uint64_t periodNs);
+
+// Loads a script of timed input changes, one per line, times in ms from when it's loaded:
+//
+//   # time  action  pins
+//   0       press   5
+//   80      release 5
+//   500     right   20 21
+//   520     left    20 21
+//   900     level   6 1
+bool loadScript(const char* path);
+
+// loads DASH_MOCK_INPUT_SCRIPT when it's set
+void configureFromEnvironment();
+
+void attachInterrupt(uint8_t pin,
+                     EdgeCallback callback,
+                     GPIO::EdgeType edge);
+bool readPin(uint8_t pin);
+
+void drawInputWindow();
+
+}  // namespace dash::platform::mock
+
+#endif  // __MOCK_INPUT_HPP__
@@ -1,8 +1,18 @@
 // mock platform
 #include "platform/platform.hpp"
+#include "platform/mock/mock_input.hpp"
 #include <can/mock/can_imgui.hpp>
-
+#include <can/can_tap.hpp>
+#include <perf/clock.hpp>
+#include <perf/latency_probe.hpp>
+#include <perf/startup_profiler.hpp>
+#include <okay/core/okay.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
 #include <cstring>
+#include <mutex>
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
@@ -10,11 +20,16 @@
 namespace dash::platform {
 
 struct GPIO::GPIOImpl {
+  uint8_t _pin = 0;
+  bool _isOutput = false;
   GpioLevel _level = GpioLevel::G_UNDEF;
 };
 
-GPIO::GPIO(uint8_t, bool)
-    : _impl(std::make_unique<GPIOImpl>()) {}
+GPIO::GPIO(uint8_t pin, bool output)
+    : _impl(std::make_unique<GPIOImpl>()) {
+  _impl->_pin = pin;
+  _impl->_isOutput = output;
+}
 
 GPIO::~GPIO() = default;
 
@@ -22,121 +37,253 @@ bool GPIO::gpio_write(GpioLevel level) {
   _impl->_level = level; 
   return true;
 }
+
+// inputs read the level the mock input source drove the pin to
 bool GPIO::gpio_read(GpioLevel& out){ 
-  out = _impl->_level; 
+  if (_impl->_isOutput) {
+    out = _impl->_level;
+  } else {
+    out = mock::readPin(_impl->_pin) ? GpioLevel::G_HIGH : GpioLevel::G_LOW;
+  }
   return true;
 }
 
-void GPIO::attachInterrupt(std::function<void()> callback, EdgeType edge) {}
+void GPIO::attachInterrupt(EdgeCallback callback, EdgeType edge) {
+  if (_impl->_isOutput) return;
+  mock::attachInterrupt(_impl->_pin, std::move(callback), edge);
+}
+
+// mock inputs don't bounce
+void GPIO::setDebouncePeriod(std::chrono::microseconds period) {}
 
 bool GPIO::checkError(){ return true; }
 
-Button::Button(uint8_t gpioPin) : _buttonID(gpioPin), _gpio(std::make_unique<GPIO>(gpioPin, false)) {}
-Button::~Button() = default;
+struct SPI::SPIImpl {
+  // noop
+};
 
-void Button::onDown(std::function<void()> callback) {}
-void Button::onUp(std::function<void()> callback) {}
+SPI::SPI(const std::string &, uint32_t, uint8_t, uint8_t)
+    : _impl(std::make_unique<SPIImpl>()) {}
+
+SPI::~SPI() = default;
 
-bool Button::isDownThisFrame() { return false; }
-bool Button::isUpThisFrame() { return false; }
-bool Button::isDown() { return false; }
+bool SPI::ISpi_write(const uint8_t *, size_t) { return false; }
 
-constexpr uint16_t Encoder::generateID(uint8_t left, uint8_t right) {
-  return static_cast<uint16_t>((static_cast<uint16_t>(left) << 8U) | right);
+bool SPI::ISpi_transfer(const uint8_t *tx, uint8_t *rx, size_t len) {
+    return false;
 }
 
-Encoder::Encoder(uint8_t leftPin, uint8_t rightPin)
-    : _encoderID(generateID(leftPin, rightPin)),
-      _leftGPIO(std::make_unique<GPIO>(leftPin, false)),
-      _rightGPIO(std::make_unique<GPIO>(rightPin, false)) {}
+// Frames shown by the mock strips are kept in a ring so the lights code can be watched and
+// checked off the car. The latest frame of each strip is drawn in the "LEDs" window, which can
+// also dump the whole ring to a CSV.
+static constexpr size_t MOCK_MAX_LEDS = 16;
+static constexpr size_t CAPTURE_FRAMES = 4096;
+
+struct CapturedFrame {
+  uint64_t timestampNs = 0;
+  uint8_t pin = 0;
+  uint8_t numLeds = 0;
+  std::array<Color, MOCK_MAX_LEDS> pixels{};
+};
+
+struct NeopixelStrip::NeopixelImpl {
+  int pin = -1;
+  int numLeds = 0;
+  std::array<Color, MOCK_MAX_LEDS> pixels{};
+  bool dirty = true;
+};
 
-Encoder::~Encoder() = default;
+static std::array<CapturedFrame, CAPTURE_FRAMES> s_capture;
+static size_t s_captureHead = 0;
+static size_t s_captureCount = 0;
+static bool s_capturePaused = false;
 
-void Encoder::onRight(std::function<void()> callback) {}
-void Encoder::onLeft(std::function<void()> callback) {}
+// latest frame per strip for the widget, strips are few and never go away
+static std::array<const NeopixelStrip::NeopixelImpl*, 4> s_strips{};
 
-bool Encoder::isIdle() { return true; }
-bool Encoder::isRightThisFrame() { return false; }
-bool Encoder::isLeftThisFrame() { return false; }
+static void captureFrame(const NeopixelStrip::NeopixelImpl& impl) {
+  if (s_capturePaused) return;
 
-InputManager::InputManager() = default;
+  CapturedFrame& frame = s_capture[s_captureHead];
+  frame.timestampNs = dash::perf::monotonicNs();
+  frame.pin = static_cast<uint8_t>(impl.pin);
+  frame.numLeds = static_cast<uint8_t>(impl.numLeds);
+  frame.pixels = impl.pixels;
 
-InputManager& InputManager::instance() {
-  static InputManager instance;
-  return instance;
+  s_captureHead = (s_captureHead + 1) % CAPTURE_FRAMES;
+  s_captureCount = std::min(s_captureCount + 1, CAPTURE_FRAMES);
 }
 
-void InputManager::registerButton(uint8_t buttonID) {}
-void InputManager::unregisterButton(uint8_t buttonID) {}
+static bool exportCapture(const char* path) {
+  FILE* file = std::fopen(path, "w");
+  if (file == nullptr) {
+    okay::Engine.logger.error("Unable to open {} for the LED capture", path);
+    return false;
+  }
+
+  std::fprintf(file, "timestamp_ns,pin");
+  for (size_t i = 0; i < MOCK_MAX_LEDS; i++) {
+    std::fprintf(file, ",led%zu", i);
+  }
+  std::fprintf(file, "\n");
+
+  size_t first = (s_captureHead + CAPTURE_FRAMES - s_captureCount) % CAPTURE_FRAMES;
+  for (size_t i = 0; i < s_captureCount; i++) {
+    const CapturedFrame& frame = s_capture[(first + i) % CAPTURE_FRAMES];
+    std::fprintf(file, "%llu,%u", static_cast<unsigned long long>(frame.timestampNs), frame.pin);
+    for (size_t led = 0; led < frame.numLeds; led++) {
+      std::fprintf(file, ",%08x", frame.pixels[led].packed);
+    }
+    std::fprintf(file, "\n");
+  }
+
+  std::fclose(file);
+  okay::Engine.logger.info("Exported {} LED frames to {}", s_captureCount, path);
+  return true;
+}
 
-void InputManager::attachDownCallback(uint8_t buttonID, std::function<void()> callback) {}
-void InputManager::attachUpCallback(uint8_t buttonID, std::function<void()> callback) {}
+static void drawLedWindow() {
+  constexpr float RADIUS = 7.0f;
+  constexpr float SPACING = 18.0f;
+
+  ImGui::Begin("LEDs");
+  ImGui::Text("%zu frames captured", s_captureCount);
+  ImGui::SameLine();
+  ImGui::Checkbox("Pause", &s_capturePaused);
+  ImGui::SameLine();
+  if (ImGui::Button("Export")) {
+    exportCapture("neopixel_capture.csv");
+  }
+  ImGui::Separator();
+
+  ImDrawList* drawList = ImGui::GetWindowDrawList();
+  for (const NeopixelStrip::NeopixelImpl* impl : s_strips) {
+    if (impl == nullptr) continue;
+
+    ImGui::Text("GPIO%d", impl->pin);
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    for (int led = 0; led < impl->numLeds; led++) {
+      // what the strip would look like, brightness premultiplied
+      glm::vec4 color = impl->pixels[led].toVec4();
+      ImU32 fill = ImGui::ColorConvertFloat4ToU32(
+          ImVec4(color.r * color.a, color.g * color.a, color.b * color.a, 1.0f));
+      ImVec2 center(origin.x + RADIUS + led * SPACING, origin.y + RADIUS);
+      drawList->AddCircleFilled(center, RADIUS, fill);
+      drawList->AddCircle(center, RADIUS, IM_COL32(80, 80, 80, 255));
+    }
+    ImGui::Dummy(ImVec2(MOCK_MAX_LEDS * SPACING, RADIUS * 2.0f + 4.0f));
+  }
+
+  ImGui::End();
+}
 
-void InputManager::executeDownCallbacks(uint8_t buttonID) {}
-void InputManager::executeUpCallbacks(uint8_t buttonID) {}
+NeopixelStrip::NeopixelStrip() : _impl(std::make_unique<NeopixelStrip::NeopixelImpl>()) {}
+NeopixelStrip::~NeopixelStrip() {
+  for (auto& strip : s_strips) {
+    if (strip == _impl.get()) strip = nullptr;
+  }
+}
 
-void InputManager::registerEncoder(uint16_t encoderID, uint8_t leftPin, uint8_t rightPin) {}
-void InputManager::unregisterEncoder(uint16_t encoderID) {}
+void NeopixelStrip::init(const int& pin, const int &numLeds) {
+  _impl->pin = pin;
+  _impl->numLeds = std::min<int>(numLeds, MOCK_MAX_LEDS);
+
+  for (auto& strip : s_strips) {
+    if (strip == nullptr || strip == _impl.get()) {
+      strip = _impl.get();
+      break;
+    }
+  }
+}
 
-void InputManager::attachLeftCallback(uint16_t encoderID, std::function<void()> callback) {}
-void InputManager::attachRightCallback(uint16_t encoderID, std::function<void()> callback) {}
+void NeopixelStrip::setColor(const int& ledIndex, Color color) {
+  if (ledIndex < 0 || ledIndex >= _impl->numLeds) return;
 
-void InputManager::executeLeftCallbacks(uint16_t encoderID) {}
-void InputManager::executeRightCallbacks(uint16_t encoderID) {}
+  if (_impl->pixels[ledIndex] != color) {
+    _impl->pixels[ledIndex] = color;
+    _impl->dirty = true;
+  }
+}
 
-void InputManager::onEncoderEdge(uint16_t encoderID) {}
+void NeopixelStrip::setPixels(std::span<const Color> pixels, int first) {
+  if (first < 0 || first + static_cast<int>(pixels.size()) > _impl->numLeds) return;
 
-bool InputManager::isDownThisFrame(uint8_t buttonID) { return false; }
-bool InputManager::isUpThisFrame(uint8_t buttonID) { return false; }
-bool InputManager::isDown(uint8_t buttonID) { return false; }
+  if (!std::equal(pixels.begin(), pixels.end(), _impl->pixels.begin() + first)) {
+    std::copy(pixels.begin(), pixels.end(), _impl->pixels.begin() + first);
+    _impl->dirty = true;
+  }
+}
 
-bool InputManager::isRightThisFrame(uint16_t encoderID) { return false; }
-bool InputManager::isLeftThisFrame(uint16_t encoderID) { return false; }
-bool InputManager::isIdle(uint16_t encoderID) { return true; }
+void NeopixelStrip::show() {
+  if (!_impl->dirty) return;
+  _impl->dirty = false;
 
-void InputManager::tick() {}
+  // captured on the spot, so the frame is complete as soon as it's submitted
+  captureFrame(*_impl);
+  dash::perf::latency::markLedComplete(dash::perf::latency::markLedSubmitted());
+  dash::perf::startup::milestone(dash::perf::startup::Milestone::FIRST_LED_FRAME);
+}
 
-struct SPI::SPIImpl {
-  // noop
-};
+void NeopixelStrip::showAll(std::span<NeopixelStrip> strips) {
+  for (NeopixelStrip& strip : strips) {
+    strip.show();
+  }
+}
 
-SPI::SPI(const std::string &, uint32_t, uint8_t, uint8_t)
-    : _impl(std::make_unique<SPIImpl>()) {}
+void NeopixelStrip::cleanup() {
+  // noop
+}
 
-SPI::~SPI() = default;
+void configureRealtime(const RealtimeConfig& config) {
+  if (config.enabled) {
+    okay::Engine.logger.info("Real-time mode is not supported on the mock platform");
+  }
+}
 
-bool SPI::ISpi_write(const uint8_t *, size_t) { return false; }
 
-bool SPI::ISpi_transfer(const uint8_t *tx, uint8_t *rx, size_t len) {
-    return false;
+void beginHardwareInit() {
+  mock::configureFromEnvironment();
 }
 
-struct NeopixelStrip::NeopixelImpl {
+void resetCANController() {}
 
+struct RealtimeThread::RealtimeThreadImpl {
+  std::thread thread;
 };
 
-NeopixelStrip::NeopixelStrip() : _impl(std::make_unique<NeopixelStrip::NeopixelImpl>()) {}
-NeopixelStrip::~NeopixelStrip() {} 
+RealtimeThread::RealtimeThread() : _impl(std::make_unique<RealtimeThreadImpl>()) {}
 
-void NeopixelStrip::init(const int& pin, const int &numLeds) {
-  // noop
-}
+RealtimeThread::~RealtimeThread() { join(); }
 
-void NeopixelStrip::setColor(const int& ledIndex, const glm::vec4 &color) {
-  // noop
+bool RealtimeThread::start(RealtimeRole role, std::function<void()> entry) {
+  if (_impl->thread.joinable()) return false;
+  _impl->thread = std::thread(std::move(entry));
+  return true;
 }
 
-void NeopixelStrip::show() {
-  // noop
+void RealtimeThread::join() {
+  if (_impl->thread.joinable()) _impl->thread.join();
 }
 
-void NeopixelStrip::cleanup() {
-  // noop
-}
+bool RealtimeThread::joinable() const { return _impl->thread.joinable(); }
+
+struct RealtimeMutex::RealtimeMutexImpl {
+  std::mutex mutex;
+};
+
+RealtimeMutex::RealtimeMutex() : _impl(std::make_unique<RealtimeMutexImpl>()) {}
+
+RealtimeMutex::~RealtimeMutex() = default;
+
+void RealtimeMutex::lock() { _impl->mutex.lock(); }
+
+void RealtimeMutex::unlock() { _impl->mutex.unlock(); }
+
+bool tickCANOffMainThread() { return false; }
 
 void configureCANDriver(CAN_Bus& bus) {
     auto canImgui = std::make_unique<CAN_IMGUI>();
-    bus.set_driver(std::move(canImgui));
+    bus.set_driver(std::make_unique<CANTap>(std::move(canImgui)));
 }
 
 void preUpdate() {
@@ -145,7 +292,17 @@ void preUpdate() {
   ImGui::NewFrame();
 }
 
+void tickDiagnostics() {
+  // nothing to report off the car
+}
+
+void tick() {
+  drawLedWindow();
+  mock::drawInputWindow();
+}
+
 void postUpdate() {
+  InputManager::instance().tick();
   ImGui::Render();
   ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
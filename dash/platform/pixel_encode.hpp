@@ -0,0 +1,118 @@
+#ifndef __PIXEL_ENCODE_HPP__
+#define __PIXEL_ENCODE_HPP__
+
+#include <platform/color.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Whole-strip color encoding: premultiplied brightness followed by gamma, producing the words
+// ws2811 expects in its leds array. The byte layout matches encodePixel, the per-strip channel
+// order is applied by ws2811 from the channel's strip_type when it renders.
+namespace dash::platform {
+
+inline void encodePixelsScalar(const Color* in, uint32_t* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = encodePixel(in[i]);
+    }
+}
+
+#if defined(__aarch64__)
+
+// 4 pixels per iteration, the 256 entry gamma table is looked up as four 64 byte tables, indices
+// outside a table come back as 0 so the four results can just be or'd together
+inline void encodePixels(const Color* in, uint32_t* out, size_t count) {
+    static const uint8x16_t ALPHA_IDX = {3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11, 15, 15, 15, 15};
+    auto loadTable = [](const uint8_t* table) {
+        return uint8x16x4_t{{vld1q_u8(table),
+                             vld1q_u8(table + 16),
+                             vld1q_u8(table + 32),
+                             vld1q_u8(table + 48)}};
+    };
+    const uint8x16x4_t lut0 = loadTable(GAMMA_LUT.data());
+    const uint8x16x4_t lut1 = loadTable(GAMMA_LUT.data() + 64);
+    const uint8x16x4_t lut2 = loadTable(GAMMA_LUT.data() + 128);
+    const uint8x16x4_t lut3 = loadTable(GAMMA_LUT.data() + 192);
+    const uint8x16_t step = vdupq_n_u8(64);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint8x16_t px = vld1q_u8(reinterpret_cast<const uint8_t*>(in + i));
+        uint8x16_t alpha = vqtbl1q_u8(px, ALPHA_IDX);
+
+        // round(c * a / 255) == (p + ((p + 128) >> 8) + 128) >> 8
+        uint16x8_t lo = vmull_u8(vget_low_u8(px), vget_low_u8(alpha));
+        uint16x8_t hi = vmull_high_u8(px, alpha);
+        uint8x16_t premul = vcombine_u8(vraddhn_u16(lo, vrshrq_n_u16(lo, 8)),
+                                        vraddhn_u16(hi, vrshrq_n_u16(hi, 8)));
+
+        uint8x16_t idx = premul;
+        uint8x16_t encoded = vqtbl4q_u8(lut0, idx);
+        idx = vsubq_u8(idx, step);
+        encoded = vorrq_u8(encoded, vqtbl4q_u8(lut1, idx));
+        idx = vsubq_u8(idx, step);
+        encoded = vorrq_u8(encoded, vqtbl4q_u8(lut2, idx));
+        idx = vsubq_u8(idx, step);
+        encoded = vorrq_u8(encoded, vqtbl4q_u8(lut3, idx));
+
+        vst1q_u8(reinterpret_cast<uint8_t*>(out + i), encoded);
+    }
+
+    encodePixelsScalar(in + i, out + i, count - i);
+}
+
+#elif defined(__SSE2__)
+
+// 4 pixels per iteration for the premultiply, SSE2 has no byte shuffle so gamma stays a table
+// lookup per byte
+inline void encodePixels(const Color* in, uint32_t* out, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(128);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+
+        __m128i lo = _mm_unpacklo_epi8(px, zero);
+        __m128i hi = _mm_unpackhi_epi8(px, zero);
+        __m128i alphaLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xFF), 0xFF);
+        __m128i alphaHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xFF), 0xFF);
+
+        // round(c * a / 255) == (t + (t >> 8)) >> 8 with t = c * a + 128
+        __m128i tLo = _mm_add_epi16(_mm_mullo_epi16(lo, alphaLo), half);
+        __m128i tHi = _mm_add_epi16(_mm_mullo_epi16(hi, alphaHi), half);
+        tLo = _mm_srli_epi16(_mm_add_epi16(tLo, _mm_srli_epi16(tLo, 8)), 8);
+        tHi = _mm_srli_epi16(_mm_add_epi16(tHi, _mm_srli_epi16(tHi, 8)), 8);
+
+        alignas(16) uint8_t premul[16];
+        _mm_store_si128(reinterpret_cast<__m128i*>(premul), _mm_packus_epi16(tLo, tHi));
+
+        for (size_t p = 0; p < 4; p++) {
+            const uint8_t* bytes = premul + p * 4;
+            out[i + p] = static_cast<uint32_t>(GAMMA_LUT[bytes[3]]) << 24 |
+                         static_cast<uint32_t>(GAMMA_LUT[bytes[2]]) << 16 |
+                         static_cast<uint32_t>(GAMMA_LUT[bytes[1]]) << 8 |
+                         static_cast<uint32_t>(GAMMA_LUT[bytes[0]]);
+        }
+    }
+
+    encodePixelsScalar(in + i, out + i, count - i);
+}
+
+#else
+
+inline void encodePixels(const Color* in, uint32_t* out, size_t count) {
+    encodePixelsScalar(in, out, count);
+}
+
+#endif
+
+}  // namespace dash::platform
+
+#endif  // __PIXEL_ENCODE_HPP__
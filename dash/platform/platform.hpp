@@ -5,12 +5,18 @@
 #include <nfr_can/IGpio.hpp>
 #include <nfr_can/ISpi.hpp>
 #include <nfr_can/CAN_interface.hpp>
+#include <platform/color.hpp>
+#include <platform/delegate.hpp>
+#include <platform/input_event.hpp>
 
 #include <glm/glm.hpp>
 
+#include <array>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
 #include <thread>
 #include <functional>
@@ -19,6 +25,12 @@
 
 namespace dash::platform {
 
+// input callbacks are delegates rather than std::functions, so attaching and dispatching them
+// never touches the heap
+using Callback = Delegate<void()>;
+using EdgeCallback = Delegate<void(const InputEvent&)>;
+using DeltaCallback = Delegate<void(int)>;
+
 class GPIO : public IGpio {
 public:
   enum class EdgeType {
@@ -33,7 +45,10 @@ public:
   bool gpio_write(GpioLevel level) override;
   bool gpio_read(GpioLevel& out) override;
 
-  void attachInterrupt(std::function<void()> callback, EdgeType edge);
+  void attachInterrupt(EdgeCallback callback, EdgeType edge);
+
+  // edges are only reported once the line has been stable this long, takes effect at startup
+  void setDebouncePeriod(std::chrono::microseconds period);
 
   bool checkError();
 
@@ -82,12 +97,18 @@ class NeopixelStrip {
     ~NeopixelStrip();
 
     void init(const int& pin, const int& numLeds);
-    void setColor(const int& ledIndex, const glm::vec4& color);
+    void setColor(const int& ledIndex, Color color);
+    // encodes a run of pixels starting at first in one batch, bounds are checked once
+    void setPixels(std::span<const Color> pixels, int first = 0);
     void show();
     void cleanup();
 
-   private:
+    // shows every changed strip, ordering renders on shared channels to minimise pin switches
+    static void showAll(std::span<NeopixelStrip> strips);
+
     struct NeopixelImpl;
+
+   private:
     std::unique_ptr<NeopixelImpl> _impl;
 };
 
@@ -100,11 +121,14 @@ public:
     UP
   };
 
+  // long enough for a mechanical switch to settle, short enough not to be felt
+  static constexpr std::chrono::microseconds DEBOUNCE_PERIOD{5000};
+
   Button(uint8_t gpioPin);
   ~Button();
 
-  void onDown(std::function<void()> callback);
-  void onUp(std::function<void()> callback);
+  void onDown(Callback callback);
+  void onUp(Callback callback);
 
   bool isDownThisFrame();
   bool isUpThisFrame();
@@ -115,6 +139,24 @@ private:
   std::unique_ptr<GPIO> _gpio;
 };
 
+// Maps how fast the encoder is spun (detents per second) to how many steps each detent is worth.
+// Up to slowDetentsPerSec a detent is one step, from fastDetentsPerSec on it's maxStepsPerDetent,
+// and in between it follows a power curve so medium speeds stay precise.
+struct EncoderAcceleration {
+  float slowDetentsPerSec = 8.0f;
+  float fastDetentsPerSec = 40.0f;
+  uint8_t maxStepsPerDetent = 8;
+  float exponent = 2.0f;
+
+  int stepsFor(float detentsPerSec) const {
+    if (detentsPerSec <= slowDetentsPerSec || maxStepsPerDetent <= 1) return 1;
+    if (detentsPerSec >= fastDetentsPerSec) return maxStepsPerDetent;
+
+    float t = (detentsPerSec - slowDetentsPerSec) / (fastDetentsPerSec - slowDetentsPerSec);
+    return 1 + static_cast<int>(std::pow(t, exponent) * (maxStepsPerDetent - 1) + 0.5f);
+  }
+};
+
 // figure out how to implement this
 class Encoder {
 public:
@@ -124,16 +166,26 @@ public:
     IDLE
   };
 
+  // the contacts chatter for well under a quadrature phase, even on a fast spin (~2ms)
+  static constexpr std::chrono::microseconds DEBOUNCE_PERIOD{500};
+
   Encoder(uint8_t leftPin, uint8_t rightPin);
   ~Encoder();
 
-  void onRight(std::function<void()> callback);
-  void onLeft(std::function<void()> callback);
+  void onRight(Callback callback);
+  void onLeft(Callback callback);
+
+  // called once per frame with the accelerated steps turned that frame, right is positive
+  void onDelta(DeltaCallback callback);
+  void setAcceleration(const EncoderAcceleration& acceleration);
 
   bool isIdle();
   bool isRightThisFrame();
   bool isLeftThisFrame();
 
+  int deltaThisFrame();
+  float velocity();  // detents per second, 0 once the encoder has been still for a moment
+
 private:
   constexpr uint16_t generateID(uint8_t left, uint8_t right);
   uint16_t _encoderID;
@@ -148,8 +200,8 @@ public:
   void registerButton(uint8_t buttonID);
   void unregisterButton(uint8_t buttonID);
 
-  void attachDownCallback(uint8_t buttonID, std::function<void()> callback);
-  void attachUpCallback(uint8_t buttonID, std::function<void()> callback);
+  void attachDownCallback(uint8_t buttonID, Callback callback);
+  void attachUpCallback(uint8_t buttonID, Callback callback);
   
   void executeDownCallbacks(uint8_t buttonID);
   void executeUpCallbacks(uint8_t buttonID);
@@ -157,13 +209,23 @@ public:
   void registerEncoder(uint16_t encoderID, uint8_t leftPin, uint8_t rightPin);
   void unregisterEncoder(uint16_t encoderID);
 
-  void attachLeftCallback(uint16_t encoderID, std::function<void()> callback);
-  void attachRightCallback(uint16_t encoderID, std::function<void()> callback);
+  void attachLeftCallback(uint16_t encoderID, Callback callback);
+  void attachRightCallback(uint16_t encoderID, Callback callback);
   
   void executeLeftCallbacks(uint16_t encoderID);
   void executeRightCallbacks(uint16_t encoderID);
 
-  void onEncoderEdge(uint16_t encoderID);
+  void attachDeltaCallback(uint16_t encoderID, DeltaCallback callback);
+  void setEncoderAcceleration(uint16_t encoderID, const EncoderAcceleration& acceleration);
+
+  // queues an edge from a registered button or encoder pin, processed in order by tick()
+  void pushEvent(const InputEvent& event);
+
+  // the edges tick() processed this frame, oldest first
+  std::span<const InputEvent> frameEvents() const;
+
+  // edges dropped because more than EVENT_CAPACITY arrived within one frame
+  uint32_t overflowCount() const;
 
   // add left and right callbacks, which take the left or right pin number
 
@@ -174,39 +236,187 @@ public:
   bool isRightThisFrame(uint16_t encoderID) const;
   bool isLeftThisFrame(uint16_t encoderID) const;
   bool isIdle(uint16_t encoderID) const;
+  int deltaThisFrame(uint16_t encoderID) const;
+  float encoderVelocity(uint16_t encoderID) const;
 
+  // beginFrame, pollInputEvents, endFrame
   void tick();
 
+  // tick() split around the backend poll, so events can be pushed in between without hardware
+  void beginFrame();
+  void endFrame();
+
+  static constexpr size_t MAX_ENCODERS = 4;
+
+  // registered inputs, for tools like the mock input window
+  uint32_t buttonPinMask() const { return _buttonPins; }
+  bool encoderAt(size_t slot, uint16_t& encoderID, uint8_t& pinA, uint8_t& pinB) const;
+
+  static constexpr size_t EVENT_CAPACITY = 256;
+
 private:
   InputManager();
   InputManager(const InputManager&) = delete;
   InputManager& operator=(const InputManager&) = delete;
 
-  std::unordered_map<uint8_t, bool> _buttonEventHappened;
-  std::unordered_map<uint8_t, std::vector<std::function<void()>>> _downCallbacks;
-  std::unordered_map<uint8_t, std::vector<std::function<void()>>> _upCallbacks;
-  std::unordered_map<uint8_t, Button::ButtonState> _buttonStates;
+  void onButtonEdge(uint8_t buttonID, const InputEvent& event);
+  void onEncoderEdge(size_t slot, const InputEvent& event);
+
+  InputEventRing<EVENT_CAPACITY> _events;
+  std::array<InputEvent, EVENT_CAPACITY> _frameEvents{};
+  size_t _frameEventCount = 0;
+  uint32_t _reportedOverflows = 0;
+
+  // the CM4 header exposes GPIO0-27, so every per-pin table is a flat array indexed by pin
+  static constexpr uint8_t MAX_PINS = 28;
+  static constexpr size_t MAX_CALLBACKS = 4;
+
+  // detents further apart than this start a new spin, velocity drops back to 0
+  static constexpr uint64_t ENCODER_IDLE_NS = 250'000'000;
+
+  template <typename... Args>
+  struct CallbackSlots {
+    std::array<Delegate<void(Args...)>, MAX_CALLBACKS> callbacks;
+    uint8_t count = 0;
+
+    bool add(Delegate<void(Args...)> callback) {
+      if (count == MAX_CALLBACKS) return false;
+      callbacks[count++] = std::move(callback);
+      return true;
+    }
+
+    void run(Args... args) const {
+      for (uint8_t i = 0; i < count; i++) {
+        callbacks[i](args...);
+      }
+    }
+
+    void clear() {
+      for (uint8_t i = 0; i < count; i++) {
+        callbacks[i] = nullptr;
+      }
+      count = 0;
+    }
+  };
 
   struct EncoderRuntime {
+    uint16_t id = 0;
     uint8_t pinA = 0;
     uint8_t pinB = 0;
     uint8_t prevAB = 0;
     int8_t accum = 0;
+    int8_t lastDirection = 0;
+    bool used = false;
     bool initialized = false;
-    Encoder::EncoderState state = Encoder::EncoderState::IDLE;
+    uint64_t lastDetentNs = 0;
+    float velocity = 0.0f;  // detents per second, smoothed
+    int32_t frameDelta = 0;
+    EncoderAcceleration acceleration{};
+    CallbackSlots<> left;
+    CallbackSlots<> right;
+    CallbackSlots<int> delta;
   };
 
-  std::unordered_map<uint16_t, std::vector<std::function<void()>>> _leftCallbacks;
-  std::unordered_map<uint16_t, std::vector<std::function<void()>>> _rightCallbacks;
-  std::unordered_map<uint16_t, EncoderRuntime> _encoderStates;
+  void onDetent(EncoderRuntime& e, int8_t direction, uint64_t timestampNs);
+
+  static uint32_t pinBit(uint8_t pin) { return 1u << pin; }
+  int encoderSlot(uint16_t encoderID) const;
+
+  // button state, one bit per pin
+  uint32_t _buttonPins = 0;
+  uint32_t _downPins = 0;
+  uint32_t _downThisFrame = 0;
+  uint32_t _upThisFrame = 0;
+
+  std::array<CallbackSlots<>, MAX_PINS> _downCallbacks{};
+  std::array<CallbackSlots<>, MAX_PINS> _upCallbacks{};
+
+  // encoder state, dense slots with one bit per slot
+  std::array<EncoderRuntime, MAX_ENCODERS> _encoders{};
+  uint32_t _encoderPins = 0;
+  std::array<int8_t, MAX_PINS> _pinEncoder;  // slot per pin, -1 when the pin isn't an encoder's
+  uint8_t _leftThisFrame = 0;
+  uint8_t _rightThisFrame = 0;
+};
+
+enum class RealtimeRole {
+  CAN,
+  INPUT
+};
+
+// Real-time execution mode. When enabled, memory is locked and prefaulted at startup and the CAN
+// and input threads run under SCHED_FIFO, pinned to their own (ideally isolcpus'd) cores. The main
+// (render) thread and any other thread stay under the normal scheduler.
+struct RealtimeConfig {
+  bool enabled = false;
+  int canPriority = 80;
+  int inputPriority = 70;
+  int canCpu = 3;
+  int inputCpu = 2;
+  size_t heapPrefaultBytes = 8 * 1024 * 1024;
+  size_t stackBytes = 256 * 1024;
+};
+
+void configureRealtime(const RealtimeConfig& config);
+
+// thread with a preallocated, prefaulted stack that starts under its role's scheduling policy
+class RealtimeThread {
+public:
+  RealtimeThread();
+  ~RealtimeThread();
+
+  bool start(RealtimeRole role, std::function<void()> entry);
+  void join();
+  bool joinable() const;
+
+private:
+  struct RealtimeThreadImpl;
+  std::unique_ptr<RealtimeThreadImpl> _impl;
+};
+
+// mutex shared between a real-time thread and normal ones. On the rpi it uses priority
+// inheritance, so a normal thread holding it runs at the waiter's priority until it unlocks.
+class RealtimeMutex {
+public:
+  RealtimeMutex();
+  ~RealtimeMutex();
+  RealtimeMutex(const RealtimeMutex&) = delete;
+  RealtimeMutex& operator=(const RealtimeMutex&) = delete;
+
+  void lock();
+  void unlock();
+
+private:
+  struct RealtimeMutexImpl;
+  std::unique_ptr<RealtimeMutexImpl> _impl;
 };
 
+// starts LED, GPIO and CAN controller bring-up concurrently, call as early as possible in main
+void beginHardwareInit();
+
 void tick();
 void configureCANDriver(CAN_Bus& bus);
 
+// sends the controller a reset so a failed init can be retried from a clean state
+void resetCANController();
+
+// true when the CAN driver may be ticked from its own thread. The mock's driver is an ImGui
+// window, so there the bus has to be ticked from the main loop.
+bool tickCANOffMainThread();
+
 void preUpdate();
 void postUpdate();
 
+// periodic platform stats logging, run as the main loop's diagnostics stage so it can be shed
+void tickDiagnostics();
+
+// Backend half of the input code, InputManager itself is shared between platforms. Polling
+// pushes the edges that arrived since the last call through the pins' interrupt callbacks, and
+// readInputPins returns the current pin levels.
+void pollInputEvents();
+// every pin in mask at once (one syscall on the rpi), bit n of levels is pin n
+bool readInputPins(uint32_t mask, uint32_t& levels);
+
 } // namespace dash::platform
 
 #endif  // __PLATFORM_H__
@@ -52,12 +52,18 @@ struct GPIO::GPIOImpl {
     return GPIOManager::instance().gpioReadPin(_pin, out);
   }
 
-  void attachInterrupt(std::function<void()> callback, EdgeType edge){
+  void attachInterrupt(EdgeCallback callback, EdgeType edge){
     if(_isOutput) return;
 
     GPIOManager::instance().registerInterrupt(_pin, _settings, callback, edge);
   }
 
+  void setDebouncePeriod(std::chrono::microseconds period){
+    if(_isOutput) return;
+
+    GPIOManager::instance().setDebouncePeriod(_pin, period);
+  }
+
   bool checkError() { return err; }
   
 };
@@ -75,10 +81,14 @@ bool GPIO::gpio_read(GpioLevel& out) {
   return _impl->read(out);
 }
 
-void GPIO::attachInterrupt(std::function<void()> callback, EdgeType edge){
+void GPIO::attachInterrupt(EdgeCallback callback, EdgeType edge){
   _impl->attachInterrupt(std::move(callback), edge);
 }
 
+void GPIO::setDebouncePeriod(std::chrono::microseconds period){
+  _impl->setDebouncePeriod(period);
+}
+
 bool GPIO::checkError() { return _impl->checkError(); }
 
 } // namespace dash::platform
@@ -1,16 +1,47 @@
 #include <platform/rpi/gpio_manager.hpp>
 
 #include <gpiod.hpp>
+#include <okay/core/okay.hpp>
+#include <perf/clock.hpp>
+#include <perf/trace.hpp>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
 
 namespace dash::platform {
 
+static constexpr uint64_t LATENCY_LOG_INTERVAL_NS = 5'000'000'000ULL;
+
 GPIOManager& GPIOManager::instance(){
     static GPIOManager instance;
     return instance;
 }
 
 GPIOManager::GPIOManager() :
-    _chip(std::make_unique<gpiod::chip>("/dev/gpiochip0")) {}
+    _chip(std::make_unique<gpiod::chip>("/dev/gpiochip0")) {
+    _offsets.reserve(MAX_PINS);
+    _values.reserve(MAX_PINS);
+}
+
+GPIOManager::~GPIOManager() {
+    if (_stopFd < 0) {
+        return;
+    }
+
+    uint64_t one = 1;
+    if (write(_stopFd, &one, sizeof(one)) != sizeof(one)) {
+        okay::Engine.logger.error("Unable to stop the gpio event thread: {}", std::strerror(errno));
+    }
+    _eventThread.join();
+    close(_stopFd);
+}
 
 bool GPIOManager::registerPin(uint8_t offset, gpiod::line_settings settings) {
     if (_settings.find(offset) != _settings.end()) {
@@ -26,16 +57,18 @@ void GPIOManager::releasePin(uint8_t offset){
         _settings.erase(offset);
     }
 
-    if (_risingCallbacks.find(offset) != _risingCallbacks.end()){
-        _risingCallbacks.erase(offset);
+    if (offset < MAX_PINS){
+        _risingCallbacks[offset] = nullptr;
+        _fallingCallbacks[offset] = nullptr;
     }
+}
 
-    if (_fallingCallbacks.find(offset) != _fallingCallbacks.end()){
-        _fallingCallbacks.erase(offset);
+void GPIOManager::registerInterrupt(uint8_t offset, gpiod::line_settings settings, EdgeCallback callback, GPIO::EdgeType edge){
+    if (offset >= MAX_PINS) {
+        okay::Engine.logger.error("Unable to attach an interrupt to pin {}, out of range", offset);
+        return;
     }
-}
 
-void GPIOManager::registerInterrupt(uint8_t offset, gpiod::line_settings settings, std::function<void()> callback, GPIO::EdgeType edge){
     _settings[offset] = settings;
 
     if (edge == GPIO::EdgeType::FALLING || edge == GPIO::EdgeType::BOTH){
@@ -48,33 +81,286 @@ void GPIOManager::registerInterrupt(uint8_t offset, gpiod::line_settings setting
     
 }
 
+void GPIOManager::setDebouncePeriod(uint8_t offset, std::chrono::microseconds period){
+    if (offset >= MAX_PINS) {
+        return;
+    }
+    _debounce[offset] = period;
+}
+
 void GPIOManager::start(){
+    if (_started) {
+        return;
+    }
+    _started = true;
+
     gpiod::line_config line_cfg = gpiod::line_config();
 
     for (auto const& [offset, settings] : _settings) {
-        line_cfg.add_line_settings(offset, settings);
+        gpiod::line_settings lineSettings = settings;
+        if (offset < MAX_PINS && _debounce[offset].count() > 0) {
+            lineSettings.set_debounce_period(_debounce[offset]);
+        }
+        line_cfg.add_line_settings(offset, lineSettings);
     }
 
+    // the kernel's default is 16 events per line, deep enough for a burst from a fast encoder
+    // spin to wait for the event thread without being dropped
+    gpiod::request_config request_cfg = gpiod::request_config();
+    request_cfg.set_consumer("dash").set_event_buffer_size(KERNEL_EVENT_BUFFER_SIZE);
+
     _request = std::make_unique<gpiod::line_request>(
-        _chip->prepare_request().set_line_config(line_cfg).do_request()
+        _chip->prepare_request()
+            .set_request_config(request_cfg)
+            .set_line_config(line_cfg)
+            .do_request()
     );
+
+    startEventThread();
+}
+
+// Edges are picked up by a thread blocked on the request's fd, so they're read (and timestamped
+// against the frame) as soon as the kernel has them rather than at the next frame. Without the
+// thread (DASH_GPIO_EVENT_THREAD=0, or it couldn't start) tick() polls the fd once per frame.
+void GPIOManager::startEventThread() {
+    const char* env = std::getenv("DASH_GPIO_EVENT_THREAD");
+    if (env != nullptr && std::atoi(env) == 0) {
+        okay::Engine.logger.info("GPIO event thread disabled, polling edges once per frame");
+        return;
+    }
+
+    _stopFd = eventfd(0, EFD_CLOEXEC);
+    if (_stopFd < 0) {
+        okay::Engine.logger.error("Unable to create the gpio event thread's eventfd: {}",
+                                  std::strerror(errno));
+        return;
+    }
+
+    if (!_eventThread.start(RealtimeRole::INPUT, [this] { runEventThread(); })) {
+        okay::Engine.logger.error(
+            "Unable to start the gpio event thread, polling edges once per frame");
+        close(_stopFd);
+        _stopFd = -1;
+        return;
+    }
+
+    _threaded.store(true, std::memory_order_release);
+}
+
+void GPIOManager::runEventThread() {
+    dash::perf::trace::setThreadName("gpio events");
+
+    pollfd fds[2] = {
+        {.fd = _request->fd(), .events = POLLIN, .revents = 0},
+        {.fd = _stopFd, .events = POLLIN, .revents = 0},
+    };
+
+    while (true) {
+        int ready = poll(fds, 2, -1);
+        countSyscalls(1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            okay::Engine.logger.error("GPIO event thread stopped, poll failed: {}",
+                                      std::strerror(errno));
+            _threaded.store(false, std::memory_order_release);
+            return;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            return;
+        }
+
+        if (!(fds[0].revents & POLLIN)) {
+            continue;
+        }
+
+        std::size_t num_events = readEvents();
+        for (std::size_t i = 0; i < num_events; i++) {
+            // the main thread is far behind if this happens, the count shows up in the stats log
+            if (!_edges.push(toInputEvent(_eventBuffer.get_event(i)))) {
+                _droppedEdges.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+size_t GPIOManager::readEvents() {
+    // the last read filled the buffer, so more were waiting and this one takes twice as many.
+    // grown here, once the previous events are consumed, and it only allocates those few times
+    if (_growEventBuffer) {
+        _growEventBuffer = false;
+        _eventBufferSize *= 2;
+        _eventBuffer = gpiod::edge_event_buffer(_eventBufferSize);
+    }
+
+    std::size_t num_events;
+    {
+        std::lock_guard<RealtimeMutex> lock(_requestMutex);
+        num_events = _request->read_edge_events(_eventBuffer, _eventBufferSize);
+    }
+    countSyscalls(1);
+
+    for (std::size_t i = 0; i < num_events; i++) {
+        uint64_t sequence = _eventBuffer.get_event(i).global_seqno();
+        if (_lastSequence != 0 && sequence > _lastSequence + 1) {
+            _kernelDroppedEdges.fetch_add(static_cast<uint32_t>(sequence - _lastSequence - 1),
+                                          std::memory_order_relaxed);
+        }
+        _lastSequence = sequence;
+    }
+
+    _growEventBuffer = num_events == _eventBufferSize && _eventBufferSize < MAX_EVENT_BUFFER_SIZE;
+
+    return num_events;
+}
+
+InputEvent GPIOManager::toInputEvent(const gpiod::edge_event& event) {
+    return InputEvent{
+        .pin = static_cast<uint8_t>(event.line_offset()),
+        .edge = event.type() == gpiod::edge_event::event_type::RISING_EDGE
+                    ? InputEvent::Edge::RISING
+                    : InputEvent::Edge::FALLING,
+        .timestampNs = static_cast<uint64_t>(event.timestamp_ns()),
+        .sequence = static_cast<uint64_t>(event.global_seqno()),
+    };
+}
+
+void GPIOManager::dispatch(const InputEvent& event) {
+    if (event.pin < MAX_PINS) {
+        const EdgeCallback& callback = event.edge == InputEvent::Edge::RISING
+                                           ? _risingCallbacks[event.pin]
+                                           : _fallingCallbacks[event.pin];
+        if (callback) {
+            callback(event);
+        }
+    }
+
+    uint64_t latencyNs = dash::perf::monotonicNs() - event.timestampNs;
+    _latencySumNs += latencyNs;
+    _latencyMaxNs = std::max(_latencyMaxNs, latencyNs);
+    _latencyCount++;
+}
+
+void GPIOManager::logLatency(uint64_t nowNs) {
+    if (nowNs - _lastLatencyLogNs < LATENCY_LOG_INTERVAL_NS) {
+        return;
+    }
+    _lastLatencyLogNs = nowNs;
+
+    // lost input, so it's worth more than a debug line
+    uint32_t kernelDropped = _kernelDroppedEdges.exchange(0, std::memory_order_relaxed);
+    if (kernelDropped > 0) {
+        okay::Engine.logger.warn("{} GPIO edges were dropped by the kernel in the last 5s",
+                                 kernelDropped);
+    }
+
+    uint32_t dropped = _droppedEdges.exchange(0, std::memory_order_relaxed);
+    if (_latencyCount == 0 && dropped == 0) {
+        return;
+    }
+
+    uint64_t syscalls = syscallCount();
+    uint64_t windowSyscalls = syscalls - _lastSyscalls;
+    _lastSyscalls = syscalls;
+
+    okay::Engine.logger.debug(
+        "GPIO edges ({}): {} dispatched, avg {} us, max {} us, {} dropped, {:.2f} syscalls/edge",
+        _threaded.load(std::memory_order_acquire) ? "event thread" : "polled",
+        _latencyCount,
+        _latencyCount > 0 ? _latencySumNs / _latencyCount / 1000 : 0,
+        _latencyMaxNs / 1000,
+        dropped,
+        _latencyCount > 0 ? static_cast<double>(windowSyscalls) / _latencyCount : 0.0);
+    dash::perf::trace::counter("gpio_latency_max_us", static_cast<int64_t>(_latencyMaxNs / 1000));
+
+    _latencySumNs = 0;
+    _latencyMaxNs = 0;
+    _latencyCount = 0;
 }
 
 bool GPIOManager::gpioWritePin(uint8_t offset, GpioLevel level){
+    if (!_request) {
+        return false;
+    }
+
     gpiod::line::value val = (level == GpioLevel::G_LOW ? gpiod::line::value::INACTIVE : gpiod::line::value::ACTIVE);
-    _request->set_value(offset, val);
+    {
+        std::lock_guard<RealtimeMutex> lock(_requestMutex);
+        _request->set_value(offset, val);
+    }
+    countSyscalls(1);
     return true;
 }
 
 bool GPIOManager::gpioReadPin(uint8_t offset, GpioLevel& out){
-    gpiod::line::value val = _request->get_value(offset);
+    if (!_request) {
+        return false;
+    }
+
+    gpiod::line::value val;
+    {
+        std::lock_guard<RealtimeMutex> lock(_requestMutex);
+        val = _request->get_value(offset);
+    }
+    countSyscalls(1);
     out = (val == gpiod::line::value::ACTIVE ? GpioLevel::G_HIGH : GpioLevel::G_LOW);
     return true;
 }
 
+void GPIOManager::fillOffsets(uint32_t mask){
+    _offsets.clear();
+    for (uint8_t pin = 0; pin < MAX_PINS; pin++) {
+        if (mask & (1u << pin)) {
+            _offsets.push_back(pin);
+        }
+    }
+}
+
+bool GPIOManager::readPins(uint32_t mask, uint32_t& levels){
+    levels = 0;
+    if (!_request || mask == 0) {
+        return false;
+    }
+
+    fillOffsets(mask);
+    _values.resize(_offsets.size());
+    {
+        std::lock_guard<RealtimeMutex> lock(_requestMutex);
+        _request->get_values(_offsets, _values);
+    }
+    countSyscalls(1);
+
+    for (size_t i = 0; i < _offsets.size(); i++) {
+        if (_values[i] == gpiod::line::value::ACTIVE) {
+            levels |= 1u << _offsets[i];
+        }
+    }
+    return true;
+}
+
+bool GPIOManager::writePins(uint32_t mask, uint32_t values){
+    if (!_request || mask == 0) {
+        return false;
+    }
+
+    fillOffsets(mask);
+    _values.clear();
+    for (gpiod::line::offset offset : _offsets) {
+        _values.push_back((values & (1u << offset)) ? gpiod::line::value::ACTIVE
+                                                     : gpiod::line::value::INACTIVE);
+    }
+    {
+        std::lock_guard<RealtimeMutex> lock(_requestMutex);
+        _request->set_values(_offsets, _values);
+    }
+    countSyscalls(1);
+    return true;
+}
+
 void GPIOManager::tick(){
+    DASH_TRACE_SCOPE("GPIOManager::tick");
+
     if (!_started) {
-        _started = true;
         start();
     }
 
@@ -82,27 +368,22 @@ void GPIOManager::tick(){
         return;
     }
 
-    if (!_request->wait_edge_events(std::chrono::nanoseconds(0))) {
-        return;
+    InputEvent event;
+    while (_edges.pop(event)) {
+        dispatch(event);
     }
 
-    gpiod::edge_event_buffer buffer(64);
-    std::size_t num_events = _request->read_edge_events(buffer);
-
-    for (std::size_t i = 0; i < num_events; i++) {
-        const auto& event = buffer.get_event(i);
-        uint8_t offset = static_cast<uint8_t>(event.line_offset());
-
-        if (event.type() == gpiod::edge_event::event_type::RISING_EDGE) {
-            auto it = _risingCallbacks.find(offset);
-            if (it != _risingCallbacks.end()) {
-                it->second();
-            }
-        } else if (event.type() == gpiod::edge_event::event_type::FALLING_EDGE) {
-            auto it = _fallingCallbacks.find(offset);
-            if (it != _fallingCallbacks.end()) {
-                it->second();
-            }
+    bool polled = !_threaded.load(std::memory_order_acquire);
+    bool pending = false;
+    if (polled) {
+        std::lock_guard<RealtimeMutex> lock(_requestMutex);
+        pending = _request->wait_edge_events(std::chrono::nanoseconds(0));
+        countSyscalls(1);
+    }
+    if (pending) {
+        std::size_t num_events = readEvents();
+        for (std::size_t i = 0; i < num_events; i++) {
+            dispatch(toInputEvent(_eventBuffer.get_event(i)));
         }
     }
 }
@@ -1,7 +1,11 @@
 #include <platform/platform.hpp>
+#include <platform/spsc_queue.hpp>
 
 #include <gpiod.hpp>
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <unordered_map>
 
@@ -13,26 +17,91 @@ public:
 
     bool registerPin(uint8_t offset, gpiod::line_settings settings);
     void releasePin(uint8_t offset);
-    void registerInterrupt(uint8_t offset, gpiod::line_settings settings, std::function<void()> callback, GPIO::EdgeType edge);
+    void registerInterrupt(uint8_t offset, gpiod::line_settings settings, EdgeCallback callback, GPIO::EdgeType edge);
+
+    // kernel debounce for a line, applied when the request is made in start()
+    void setDebouncePeriod(uint8_t offset, std::chrono::microseconds period);
 
     void start();
 
     bool gpioWritePin(uint8_t offset, GpioLevel level);
     bool gpioReadPin(uint8_t offset, GpioLevel& out);
 
+    // every pin in mask in a single ioctl, bit n is pin n. the offsets and values are kept in
+    // preallocated vectors, so neither allocates
+    bool readPins(uint32_t mask, uint32_t& levels);
+    bool writePins(uint32_t mask, uint32_t values);
+
+    // syscalls made on the line request since startup, from any thread
+    uint64_t syscallCount() const { return _syscalls.load(std::memory_order_relaxed); }
+
+    // dispatches the edges seen since the last call, on the calling (main) thread
     void tick();
 
+    // edge latency and drop stats, logged at most every 5s; main thread
+    void logLatency(uint64_t nowNs);
+
 private:
     GPIOManager();
+    ~GPIOManager();
     GPIOManager(const GPIOManager&) = delete;
     GPIOManager& operator=(const GPIOManager&) = delete;
 
-    std::unordered_map<uint8_t, std::function<void()>> _risingCallbacks;
-    std::unordered_map<uint8_t, std::function<void()>> _fallingCallbacks;
+    static constexpr uint8_t MAX_PINS = 28;
+    static constexpr size_t MIN_EVENT_BUFFER_SIZE = 64;
+    static constexpr size_t MAX_EVENT_BUFFER_SIZE = 1024;
+    static constexpr size_t KERNEL_EVENT_BUFFER_SIZE = 1024;
+    static constexpr size_t EDGE_QUEUE_SIZE = 256;
+
+    void startEventThread();
+    void runEventThread();
+    size_t readEvents();
+    void dispatch(const InputEvent& event);
+    static InputEvent toInputEvent(const gpiod::edge_event& event);
+
+    // indexed by pin, an empty delegate means nothing is attached
+    std::array<EdgeCallback, MAX_PINS> _risingCallbacks{};
+    std::array<EdgeCallback, MAX_PINS> _fallingCallbacks{};
     std::unordered_map<uint8_t, gpiod::line_settings> _settings;
 
     std::unique_ptr<gpiod::chip> _chip;
     std::unique_ptr<gpiod::line_request> _request;
+    // a line_request isn't thread-safe, every call on it after start() holds this. the event
+    // thread reads edges while the main thread reads and writes levels
+    RealtimeMutex _requestMutex;
+
+    void countSyscalls(uint64_t count) { _syscalls.fetch_add(count, std::memory_order_relaxed); }
+    void fillOffsets(uint32_t mask);
+
+    std::atomic<uint64_t> _syscalls{0};
+    uint64_t _lastSyscalls = 0;
+    gpiod::line::offsets _offsets;
+    gpiod::line::values _values;
+
+    // per-line debounce, 0 leaves the line undebounced
+    std::array<std::chrono::microseconds, MAX_PINS> _debounce{};
+
+    // reused for every read, by the event thread or by tick() when polling. it grows when a read
+    // fills it, so a burst is read in one go instead of several
+    gpiod::edge_event_buffer _eventBuffer{MIN_EVENT_BUFFER_SIZE};
+    size_t _eventBufferSize = MIN_EVENT_BUFFER_SIZE;
+    bool _growEventBuffer = false;
+
+    // gaps in the kernel's sequence numbers are events its buffer overflowed on
+    uint64_t _lastSequence = 0;
+    std::atomic<uint32_t> _kernelDroppedEdges{0};
+
+    RealtimeThread _eventThread;
+    SpscQueue<InputEvent, EDGE_QUEUE_SIZE> _edges;
+    std::atomic<bool> _threaded{false};
+    std::atomic<uint32_t> _droppedEdges{0};
+    int _stopFd = -1;
+
+    // edge timestamp -> callback, over the current stats window
+    uint64_t _latencySumNs = 0;
+    uint64_t _latencyMaxNs = 0;
+    uint32_t _latencyCount = 0;
+    uint64_t _lastLatencyLogNs = 0;
 
     bool _started = false;
 };
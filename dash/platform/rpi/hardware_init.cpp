@@ -0,0 +1,94 @@
+#include <platform/rpi/hardware_init.hpp>
+#include <platform/rpi/gpio_manager.hpp>
+#include <perf/startup_profiler.hpp>
+#include <perf/trace.hpp>
+
+#include <array>
+#include <atomic>
+#include <future>
+#include <mutex>
+
+namespace dash::platform {
+
+static constexpr size_t NUM_HARDWARE = static_cast<size_t>(Hardware::COUNT);
+
+static std::array<std::shared_future<void>, NUM_HARDWARE> s_pending;
+static std::array<std::atomic<bool>, NUM_HARDWARE> s_ready{};
+static std::once_flag s_begun;
+
+CANHardware& canHardware() {
+    static CANHardware hardware;
+    return hardware;
+}
+
+static void initGPIO() {
+    // the CS pin has to be registered before the line request is made
+    canHardware();
+    GPIOManager::instance().start();
+}
+
+void resetCANController() {
+    static constexpr uint8_t MCP2515_RESET = 0xC0;
+
+    CANHardware& hardware = canHardware();
+    waitForHardware(Hardware::GPIO);
+
+    hardware.cs.gpio_write(GpioLevel::G_LOW);
+    hardware.spi.ISpi_write(&MCP2515_RESET, 1);
+    hardware.cs.gpio_write(GpioLevel::G_HIGH);
+}
+
+static void initCAN() {
+    // put the controller in a known state so the driver's init doesn't race a half-configured
+    // chip left over from the previous run
+    resetCANController();
+}
+
+static void runTask(Hardware hardware) {
+    static constexpr const char* NAMES[NUM_HARDWARE] = {"init leds", "init gpio", "init can"};
+    static constexpr const char* DONE_NAMES[NUM_HARDWARE] = {
+        "init leds done", "init gpio done", "init can done"};
+
+    size_t idx = static_cast<size_t>(hardware);
+    dash::perf::trace::setThreadName(NAMES[idx]);
+    dash::perf::startup::mark(NAMES[idx]);
+    {
+        DASH_TRACE_SCOPE(NAMES[idx]);
+        switch (hardware) {
+            case Hardware::LEDS:
+                initNeopixelHardware();
+                break;
+            case Hardware::GPIO:
+                initGPIO();
+                break;
+            case Hardware::CAN:
+                initCAN();
+                break;
+            case Hardware::COUNT:
+                break;
+        }
+    }
+    dash::perf::startup::mark(DONE_NAMES[idx]);
+}
+
+void beginHardwareInit() {
+    std::call_once(s_begun, [] {
+        for (size_t i = 0; i < NUM_HARDWARE; i++) {
+            Hardware hardware = static_cast<Hardware>(i);
+            s_pending[i] = std::async(std::launch::async, runTask, hardware).share();
+        }
+    });
+}
+
+void waitForHardware(Hardware hardware) {
+    size_t idx = static_cast<size_t>(hardware);
+    if (s_ready[idx].load(std::memory_order_acquire)) {
+        return;
+    }
+
+    beginHardwareInit();
+    s_pending[idx].wait();
+    s_ready[idx].store(true, std::memory_order_release);
+}
+
+} // namespace dash::platform
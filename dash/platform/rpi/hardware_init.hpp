@@ -0,0 +1,30 @@
+#include <platform/platform.hpp>
+
+namespace dash::platform {
+
+// Independent pieces of bring-up that run concurrently on the init pool started by
+// beginHardwareInit(). Anything that touches one of them waits for it first.
+enum class Hardware {
+    LEDS,  // ws2811 DMA + PWM setup
+    GPIO,  // gpiochip line request
+    CAN,   // spidev open + MCP2515 reset
+    COUNT
+};
+
+// blocks until the given piece is up. if beginHardwareInit() was never called it's called here,
+// so every piece is started on the pool, not just the one waited for
+void waitForHardware(Hardware hardware);
+
+struct CANHardware {
+    SPI spi;
+    GPIO cs{0, true};
+    Clock clock;
+};
+
+// constructed on first use so the spidev open doesn't happen during static init
+CANHardware& canHardware();
+
+// defined in neopixel.cpp
+void initNeopixelHardware();
+
+} // namespace dash::platform
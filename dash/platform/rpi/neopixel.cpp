@@ -1,8 +1,17 @@
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <platform/platform.hpp>
+#include <platform/pixel_encode.hpp>
 #include <drivers/neopixel/ws2811.h>
 #include <okay/core/okay.hpp>
+#include <perf/clock.hpp>
+#include <perf/latency_probe.hpp>
+#include <perf/startup_profiler.hpp>
+#include <perf/trace.hpp>
+#include <platform/rpi/hardware_init.hpp>
 
 extern "C" {
 #include <drivers/neopixel/gpio.h>
@@ -50,18 +59,51 @@ static ws2811_t s_ledString = {
 static bool s_hasInitialized{false};
 static bool s_hasCleanedUp{false};
 
-static uint32_t encodeToWWRRGGBB(glm::vec4 color) {
-    color = color * color.a;
-    return static_cast<uint32_t>(color.w * 255) << 24 | static_cast<uint32_t>(color.z * 255) << 16 |
-           static_cast<uint32_t>(color.y * 255) << 8 | static_cast<uint32_t>(color.x * 255);
-}
-
+// Each strip keeps its own back buffer that setColor writes into, so the CPU can fill the next
+// frame while the DMA engine is still clocking out the previous one. show() only copies the back
+// buffer into the channel (and waits for the DMA) when the strip actually changed.
 struct NeopixelStrip::NeopixelImpl {
     int pin;
     int numLeds;
     int channel;
+    std::array<ws2811_led_t, MAX_LEDS> back{};
+    bool dirty = true;
+    uint32_t renders = 0;
+};
+
+static bool s_dmaInFlight{false};
+// arrival of the latency sample the transfer in flight carries, 0 if none
+static uint64_t s_probeInFlightNs{0};
+
+// GPIO registers, mapped once for remuxing the shared channel
+static volatile gpio_t* s_gpio{nullptr};
+
+// strips queued on one channel for the current showAll
+static constexpr size_t MAX_STRIPS_PER_CHANNEL = 4;
+static constexpr uint64_t STATS_PERIOD_NS = 5'000'000'000ULL;
+
+struct ChannelQueue {
+    std::array<NeopixelStrip::NeopixelImpl*, MAX_STRIPS_PER_CHANNEL> strips{};
+    size_t head = 0;
+    size_t count = 0;
 };
 
+static uint64_t s_statsStartNs{0};
+static uint32_t s_remuxCount{0};
+static uint64_t s_remuxNs{0};
+
+// the channel buffers and the pin mux can't be touched while a transfer is running
+static void waitForDMA() {
+    if (!s_dmaInFlight)
+        return;
+
+    DASH_TRACE_SCOPE("ws2811_wait");
+    ws2811_wait(&s_ledString);
+    s_dmaInFlight = false;
+    dash::perf::latency::markLedComplete(s_probeInFlightNs);
+    s_probeInFlightNs = 0;
+}
+
 NeopixelStrip::NeopixelStrip() : _impl(std::make_unique<NeopixelStrip::NeopixelImpl>()) {
 }
 NeopixelStrip::~NeopixelStrip() {
@@ -83,6 +125,10 @@ void NeopixelStrip::init(const int& pin, const int& numLeds) {
         okay::Engine.logger.error("Unable to find channel for pin {}", _impl->pin);
     }
 
+    waitForHardware(Hardware::LEDS);
+}
+
+void initNeopixelHardware() {
     if (s_hasInitialized)
         return;
 
@@ -91,12 +137,18 @@ void NeopixelStrip::init(const int& pin, const int& numLeds) {
     if (code != WS2811_SUCCESS) {
         okay::Engine.logger.error("Unable to initialize neopixels : {}",
                                   ws2811_get_return_t_str(code));
+    } else {
+        const uint32_t perBase = s_ledString.rpi_hw->periph_base;
+        s_gpio = (volatile gpio_t*)mapmem(GPIO_OFFSET + perBase, sizeof(gpio_t), DEV_GPIOMEM);
+        if (!s_gpio) {
+            okay::Engine.logger.error("Unable to map gpio memory");
+        }
     }
 
     s_hasInitialized = true;
 }
 
-void NeopixelStrip::setColor(const int& ledIndex, const glm::vec4& color) {
+void NeopixelStrip::setColor(const int& ledIndex, Color color) {
     if (_impl->channel == -1) {
         okay::Engine.logger.error("Channel is -1 for pin {}", _impl->pin);
         return;
@@ -107,46 +159,181 @@ void NeopixelStrip::setColor(const int& ledIndex, const glm::vec4& color) {
         return;
     }
 
-    ws2811_channel_t* channel = &(s_ledString.channel[_impl->channel]);
-    channel->leds[ledIndex] = encodeToWWRRGGBB(color);
+    ws2811_led_t encoded = encodePixel(color);
+    if (_impl->back[ledIndex] != encoded) {
+        _impl->back[ledIndex] = encoded;
+        _impl->dirty = true;
+    }
+}
+
+void NeopixelStrip::setPixels(std::span<const Color> pixels, int first) {
+    if (_impl->channel == -1) {
+        okay::Engine.logger.error("Channel is -1 for pin {}", _impl->pin);
+        return;
+    }
+
+    if (first < 0 || first + static_cast<int>(pixels.size()) > _impl->numLeds) {
+        okay::Engine.logger.error("Leds {}..{} are out of range",
+                                  first,
+                                  first + static_cast<int>(pixels.size()));
+        return;
+    }
+
+    std::array<ws2811_led_t, MAX_LEDS> encoded;
+    encodePixels(pixels.data(), encoded.data(), pixels.size());
+
+    ws2811_led_t* dst = _impl->back.data() + first;
+    if (!std::equal(encoded.begin(), encoded.begin() + pixels.size(), dst)) {
+        std::copy_n(encoded.begin(), pixels.size(), dst);
+        _impl->dirty = true;
+    }
 }
 
-void NeopixelStrip::show() {
-    ws2811_wait(&s_ledString);
-    ws2811_channel_t* channel = &(s_ledString.channel[_impl->channel]);
-    if (channel->gpionum != _impl->pin) {
-        // Capture old pin + base BEFORE fini
-        const int oldPin = channel->gpionum;
-        const int newPin = _impl->pin;
-        const uint32_t perBase = s_ledString.rpi_hw->periph_base;
+// hands the channel's PWM output from its current pin to newPin, DMA must be idle
+static void remux(ws2811_channel_t* channel, int channelIdx, int newPin) {
+    DASH_TRACE_SCOPE("remux");
+    uint64_t startNs = dash::perf::monotonicNs();
 
-        volatile gpio_t* gpio =
-            (volatile gpio_t*)mapmem(GPIO_OFFSET + perBase, sizeof(gpio_t), DEV_GPIOMEM);
-        if (gpio) {
-            gpio_output_set(gpio, oldPin, 0);
-            gpio_output_set(gpio, newPin, 0);
+    const int oldPin = channel->gpionum;
+    if (s_gpio) {
+        gpio_output_set(s_gpio, oldPin, 0);
+        gpio_output_set(s_gpio, newPin, 0);
 
-            gpio_output_set(gpio, oldPin, 1);
-            gpio_level_set(gpio, oldPin, 0);
+        gpio_output_set(s_gpio, oldPin, 1);
+        gpio_level_set(s_gpio, oldPin, 0);
 
-            usleep(50);
-            // enable ONLY the selected pin for PWM channel 1
-            int alt = pwm_pin_alt(_impl->channel, newPin);
-            if (alt >= 0) {
-                gpio_function_set(gpio, newPin, alt);
-            }
+        usleep(50);
+        // enable ONLY the selected pin for PWM channel 1
+        int alt = pwm_pin_alt(channelIdx, newPin);
+        if (alt >= 0) {
+            gpio_function_set(s_gpio, newPin, alt);
+        }
+    }
+
+    channel->gpionum = newPin;
+    s_remuxCount++;
+    s_remuxNs += dash::perf::monotonicNs() - startNs;
+}
+
+static void logStats(std::span<NeopixelStrip::NeopixelImpl* const> strips) {
+    uint64_t now = dash::perf::monotonicNs();
+    if (s_statsStartNs == 0) {
+        s_statsStartNs = now;
+    }
+    if (now - s_statsStartNs < STATS_PERIOD_NS) {
+        return;
+    }
+
+    double seconds = static_cast<double>(now - s_statsStartNs) / 1e9;
+    for (NeopixelStrip::NeopixelImpl* impl : strips) {
+        okay::Engine.logger.debug("leds: GPIO{} {:.1f}Hz", impl->pin, impl->renders / seconds);
+        impl->renders = 0;
+    }
+    okay::Engine.logger.debug("leds: {} remuxes, {:.2f}ms/s lost to remuxing",
+                              s_remuxCount,
+                              static_cast<double>(s_remuxNs) / 1e6 / seconds);
+
+    s_statsStartNs = now;
+    s_remuxCount = 0;
+    s_remuxNs = 0;
+}
+
+// Every ws2811_render sends both channels, so each pass renders the next queued strip of every
+// channel together. On the shared channel the strip that's already muxed goes first, so a pin
+// switch only happens when the other strip actually changed, and at most once per frame when
+// both did.
+static void renderStrips(std::span<NeopixelStrip::NeopixelImpl* const> strips) {
+    std::array<ChannelQueue, RPI_PWM_CHANNELS> queues{};
+    size_t passes = 0;
+
+    for (NeopixelStrip::NeopixelImpl* impl : strips) {
+        ChannelQueue& queue = queues[impl->channel];
+        if (!impl->dirty || queue.count == MAX_STRIPS_PER_CHANNEL) {
+            continue;
+        }
+
+        if (s_ledString.channel[impl->channel].gpionum == impl->pin) {
+            std::copy_backward(queue.strips.begin(),
+                               queue.strips.begin() + queue.count,
+                               queue.strips.begin() + queue.count + 1);
+            queue.strips[0] = impl;
         } else {
-            okay::Engine.logger.error("Unable to map gpio memory");
-            // while (true) {};
+            queue.strips[queue.count] = impl;
         }
+        queue.count++;
+        passes = std::max(passes, queue.count);
+    }
+
+    if (passes > 0) {
+        DASH_TRACE_SCOPE("NeopixelStrip::showAll");
+
+        for (size_t pass = 0; pass < passes; pass++) {
+            // normally the previous frame's transfer finished long ago and this doesn't block,
+            // only a second pass on the shared channel pays for a full transfer
+            waitForDMA();
+
+            for (size_t ch = 0; ch < RPI_PWM_CHANNELS; ch++) {
+                ChannelQueue& queue = queues[ch];
+                if (queue.head == queue.count) {
+                    continue;
+                }
+
+                NeopixelStrip::NeopixelImpl* impl = queue.strips[queue.head++];
+                ws2811_channel_t* channel = &(s_ledString.channel[ch]);
+                if (channel->gpionum != impl->pin) {
+                    remux(channel, static_cast<int>(ch), impl->pin);
+                }
+
+                // the whole strip is copied, the channel buffer may hold another strip's pixels
+                std::copy_n(impl->back.begin(), impl->numLeds, channel->leds);
+                channel->count = impl->numLeds;
+                impl->dirty = false;
+                impl->renders++;
+            }
 
-        channel->gpionum = newPin;
-        channel->count = MAX_LEDS;
+            {
+                DASH_TRACE_SCOPE("ws2811_render");
+                ws2811_render(&s_ledString);
+            }
+            s_dmaInFlight = true;
+        }
+
+        // the frame is handed to the DMA engine here. one carrying a latency sample is waited out
+        // straight away, so its completion is stamped as the transfer ends and not at the next
+        // frame's wait
+        s_probeInFlightNs = dash::perf::latency::markLedSubmitted();
+        if (s_probeInFlightNs != 0) {
+            waitForDMA();
+        }
+        dash::perf::startup::milestone(dash::perf::startup::Milestone::FIRST_LED_FRAME);
     }
+}
 
-    channel->count = _impl->numLeds;
-    ws2811_render(&s_ledString);
-    ws2811_wait(&s_ledString);
+// a single strip, the render rate stats are only kept by showAll
+void NeopixelStrip::show() {
+    if (_impl->channel == -1) {
+        return;
+    }
+
+    NeopixelImpl* impl = _impl.get();
+    renderStrips(std::span<NeopixelImpl* const>(&impl, 1));
+}
+
+void NeopixelStrip::showAll(std::span<NeopixelStrip> strips) {
+    std::array<NeopixelImpl*, RPI_PWM_CHANNELS * MAX_STRIPS_PER_CHANNEL> all{};
+    size_t numAll = 0;
+
+    for (NeopixelStrip& strip : strips) {
+        NeopixelImpl* impl = strip._impl.get();
+        if (impl->channel == -1 || numAll == all.size()) {
+            continue;
+        }
+        all[numAll++] = impl;
+    }
+
+    std::span<NeopixelImpl* const> active(all.data(), numAll);
+    renderStrips(active);
+    logStats(active);
 }
 
 void NeopixelStrip::cleanup() {
@@ -155,6 +342,12 @@ void NeopixelStrip::cleanup() {
 
     s_hasCleanedUp = true;
     s_hasInitialized = false;
+    waitForDMA();
+
+    if (s_gpio) {
+        unmapmem((void*)s_gpio, sizeof(gpio_t));
+        s_gpio = nullptr;
+    }
     ws2811_fini(&s_ledString);
 }
 
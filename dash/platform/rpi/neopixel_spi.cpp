@@ -0,0 +1,205 @@
+// SPI backend for the neopixel strips, built with -DDASH_NEOPIXEL_SPI=ON in place of the
+// PWM/DMA backend in neopixel.cpp. Every strip gets its own spidev, so there's no channel to share
+// and no pin remuxing: each strip encodes its frame into a WS2812 bitstream and hands it to its
+// own worker thread, which clocks it out while the other strips do the same.
+#include <platform/platform.hpp>
+#include <platform/pixel_encode.hpp>
+#include <platform/ws2812_spi.hpp>
+#include <platform/rpi/hardware_init.hpp>
+#include <okay/core/okay.hpp>
+#include <perf/latency_probe.hpp>
+#include <perf/startup_profiler.hpp>
+#include <perf/trace.hpp>
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+
+namespace dash::platform {
+
+#define MAX_LEDS 16
+
+using StripEncoding = ws2812::Encoding<4>;
+static constexpr size_t FRAME_BYTES = StripEncoding::bufferSize(MAX_LEDS);
+
+// Strips keep their PWM pin numbers as ids, their data lines move to the MOSI of their own SPI
+// bus (Pi 4, enabled with the spi1-1cs, spi4-1cs and spi5-1cs overlays).
+struct SpiStrip {
+    int pin;
+    const char* device;
+};
+
+static constexpr SpiStrip SPI_STRIPS[] = {
+    {19, "/dev/spidev1.0"},  // left, MOSI on GPIO20
+    {13, "/dev/spidev4.0"},  // top, MOSI on GPIO6
+    {18, "/dev/spidev5.0"},  // right, MOSI on GPIO14
+};
+
+struct NeopixelStrip::NeopixelImpl {
+    int pin = -1;
+    int numLeds = 0;
+    std::array<uint32_t, MAX_LEDS> words{};
+    bool dirty = true;
+
+    std::unique_ptr<SPI> spi;
+    std::thread worker;
+
+    // the main thread encodes into pending, the worker swaps it out and sends it
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::array<uint8_t, FRAME_BYTES> pending{};
+    size_t pendingLen = 0;
+    uint64_t pendingProbeNs = 0;  // latency sample carried by pending, see markLedSubmitted
+    bool hasPending = false;
+    bool stopping = false;
+
+    void run() {
+        dash::perf::trace::setThreadName("neopixel spi");
+        std::array<uint8_t, FRAME_BYTES> sending{};
+
+        while (true) {
+            size_t len;
+            uint64_t probeNs;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return hasPending || stopping; });
+                if (!hasPending) {
+                    return;
+                }
+
+                std::swap(pending, sending);
+                len = pendingLen;
+                probeNs = pendingProbeNs;
+                pendingProbeNs = 0;
+                hasPending = false;
+            }
+
+            {
+                DASH_TRACE_SCOPE("neopixel spi write");
+                spi->ISpi_write(sending.data(), len);
+            }
+            dash::perf::latency::markLedComplete(probeNs);
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+};
+
+void initNeopixelHardware() {
+    // nothing shared to bring up, each strip opens its own spidev
+}
+
+NeopixelStrip::NeopixelStrip() : _impl(std::make_unique<NeopixelStrip::NeopixelImpl>()) {
+}
+
+NeopixelStrip::~NeopixelStrip() {
+    _impl->stop();
+}
+
+void NeopixelStrip::init(const int& pin, const int& numLeds) {
+    _impl->pin = pin;
+    _impl->numLeds = std::min(numLeds, MAX_LEDS);
+
+    const SpiStrip* strip = nullptr;
+    for (const SpiStrip& candidate : SPI_STRIPS) {
+        if (candidate.pin == pin) {
+            strip = &candidate;
+        }
+    }
+
+    if (strip == nullptr) {
+        okay::Engine.logger.error("Unable to find an spi device for pin {}", pin);
+        return;
+    }
+
+    waitForHardware(Hardware::LEDS);
+
+    _impl->spi = std::make_unique<SPI>(strip->device, StripEncoding::SPI_HZ);
+    _impl->worker = std::thread([impl = _impl.get()] { impl->run(); });
+}
+
+void NeopixelStrip::setColor(const int& ledIndex, Color color) {
+    if (ledIndex >= _impl->numLeds) {
+        okay::Engine.logger.error("Led index {} is out of range", ledIndex);
+        return;
+    }
+
+    uint32_t encoded = encodePixel(color);
+    if (_impl->words[ledIndex] != encoded) {
+        _impl->words[ledIndex] = encoded;
+        _impl->dirty = true;
+    }
+}
+
+void NeopixelStrip::setPixels(std::span<const Color> pixels, int first) {
+    if (first < 0 || first + static_cast<int>(pixels.size()) > _impl->numLeds) {
+        okay::Engine.logger.error("Leds {}..{} are out of range",
+                                  first,
+                                  first + static_cast<int>(pixels.size()));
+        return;
+    }
+
+    std::array<uint32_t, MAX_LEDS> encoded;
+    encodePixels(pixels.data(), encoded.data(), pixels.size());
+
+    uint32_t* dst = _impl->words.data() + first;
+    if (!std::equal(encoded.begin(), encoded.begin() + pixels.size(), dst)) {
+        std::copy_n(encoded.begin(), pixels.size(), dst);
+        _impl->dirty = true;
+    }
+}
+
+void NeopixelStrip::show() {
+    if (!_impl->dirty || !_impl->spi) {
+        return;
+    }
+
+    DASH_TRACE_SCOPE("NeopixelStrip::show");
+    {
+        // a frame the worker hasn't picked up yet is simply replaced by the newer one, which
+        // still shows whatever latency sample it carried
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        _impl->pendingLen =
+            StripEncoding::encode(_impl->words.data(), _impl->numLeds, _impl->pending.data());
+        _impl->hasPending = true;
+
+        // handed to the worker here, it's on the strip once the worker's write returns
+        uint64_t probeNs = dash::perf::latency::markLedSubmitted();
+        if (probeNs != 0) {
+            _impl->pendingProbeNs = probeNs;
+        }
+    }
+    _impl->wake.notify_one();
+    _impl->dirty = false;
+
+    dash::perf::startup::milestone(dash::perf::startup::Milestone::FIRST_LED_FRAME);
+}
+
+void NeopixelStrip::showAll(std::span<NeopixelStrip> strips) {
+    // the strips don't share anything, so order doesn't matter
+    for (NeopixelStrip& strip : strips) {
+        strip.show();
+    }
+}
+
+void NeopixelStrip::cleanup() {
+    // the worker sends whatever is still pending before it exits
+    _impl->stop();
+}
+
+}  // namespace dash::platform
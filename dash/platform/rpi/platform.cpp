@@ -1,27 +1,54 @@
 #include <platform/platform.hpp>
 #include <platform/rpi/gpio_manager.hpp>
+#include <platform/rpi/hardware_init.hpp>
+#include <platform/rpi/realtime.hpp>
 #include <okay/core/okay.hpp>
+#include <can/can_tap.hpp>
+#include <perf/clock.hpp>
 
 namespace dash::platform {
 
-void preUpdate() {}
+void preUpdate() {
+    // nothing to do before the frame
+}
+
+void tick() {
+    // nothing to do per frame, LED output is driven by NeopixelManager
+}
 
 void postUpdate() {
-    GPIOManager::instance().tick();
+    waitForHardware(Hardware::GPIO);
     InputManager::instance().tick();
 }
 
-static SPI s_canSpi;
-static GPIO s_canGPIO{0, true};
-static Clock s_canClock;
+void tickDiagnostics() {
+    tickRealtimeStats();
+    GPIOManager::instance().logLatency(dash::perf::monotonicNs());
+}
+
+void pollInputEvents() {
+    GPIOManager::instance().tick();
+}
+
+bool readInputPins(uint32_t mask, uint32_t& levels) {
+    return GPIOManager::instance().readPins(mask, levels);
+}
 
 void configureCANDriver(CAN_Bus& bus) {
-    bus.set_driver(std::make_unique<MCP2515>(s_canSpi, s_canGPIO, s_canClock));
+    waitForHardware(Hardware::CAN);
+
+    CANHardware& hardware = canHardware();
+    bus.set_driver(std::make_unique<CANTap>(
+        std::make_unique<MCP2515>(hardware.spi, hardware.cs, hardware.clock)));
 
     // check for errors
-    if (s_canGPIO.checkError()) {
+    if (hardware.cs.checkError()) {
         okay::Engine.logger.error("Failed to initialize GPIO");
     }
 }
 
+bool tickCANOffMainThread() {
+    return true;
+}
+
 } // namespace dash::platform
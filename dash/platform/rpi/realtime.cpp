@@ -0,0 +1,353 @@
+#include <platform/platform.hpp>
+#include <platform/rpi/realtime.hpp>
+#include <okay/core/okay.hpp>
+
+#include <alloca.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace dash::platform {
+
+static RealtimeConfig s_config;
+
+static constexpr size_t NUM_ROLES = 2;
+
+// kernel thread id of the running thread of each role, 0 while there's none. getrusage can only
+// report the calling thread or the whole process, so their counters are read from /proc instead
+static std::array<std::atomic<pid_t>, NUM_ROLES> s_roleTids{};
+
+static pid_t threadId() {
+    return static_cast<pid_t>(syscall(SYS_gettid));
+}
+
+static size_t pageSize() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+// touch every page of a stack region below the caller so that the first deep call in the hot
+// loop doesn't take a fault
+static void prefaultStack(size_t bytes) {
+    volatile uint8_t* region = static_cast<volatile uint8_t*>(alloca(bytes));
+    for (size_t i = 0; i < bytes; i += pageSize()) {
+        region[i] = 0;
+    }
+}
+
+static void prefaultHeap(size_t bytes) {
+    // keep freed memory in the arena instead of handing it back to the kernel
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+
+    uint8_t* block = static_cast<uint8_t*>(malloc(bytes));
+    if (block == nullptr) {
+        okay::Engine.logger.error("Unable to prefault {} bytes of heap", bytes);
+        return;
+    }
+
+    for (size_t i = 0; i < bytes; i += pageSize()) {
+        block[i] = 0;
+    }
+    free(block);
+}
+
+static int priorityFor(RealtimeRole role) {
+    return role == RealtimeRole::CAN ? s_config.canPriority : s_config.inputPriority;
+}
+
+static int cpuFor(RealtimeRole role) {
+    return role == RealtimeRole::CAN ? s_config.canCpu : s_config.inputCpu;
+}
+
+static const char* roleName(RealtimeRole role) {
+    return role == RealtimeRole::CAN ? "CAN" : "input";
+}
+
+void configureRealtime(const RealtimeConfig& config) {
+    s_config = config;
+    if (!s_config.enabled) {
+        return;
+    }
+
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        okay::Engine.logger.error("mlockall failed ({}), check the memlock limit",
+                                  std::strerror(errno));
+    }
+
+    prefaultHeap(s_config.heapPrefaultBytes);
+    prefaultStack(s_config.stackBytes);
+
+    okay::Engine.logger.info("Real-time mode enabled (CAN prio {} cpu {}, input prio {} cpu {})",
+                             s_config.canPriority,
+                             s_config.canCpu,
+                             s_config.inputPriority,
+                             s_config.inputCpu);
+}
+
+struct RealtimeThread::RealtimeThreadImpl {
+    pthread_t thread{};
+    bool running = false;
+    void* stack = nullptr;
+    size_t stackBytes = 0;
+    RealtimeRole role = RealtimeRole::CAN;
+    std::function<void()> entry;
+
+    static void* run(void* arg) {
+        RealtimeThreadImpl* impl = static_cast<RealtimeThreadImpl*>(arg);
+        std::atomic<pid_t>& tid = s_roleTids[static_cast<size_t>(impl->role)];
+
+        tid.store(threadId(), std::memory_order_relaxed);
+        impl->entry();
+        tid.store(0, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    ~RealtimeThreadImpl() {
+        if (stack != nullptr) {
+            munmap(stack, stackBytes);
+        }
+    }
+};
+
+RealtimeThread::RealtimeThread() : _impl(std::make_unique<RealtimeThreadImpl>()) {}
+
+RealtimeThread::~RealtimeThread() {
+    join();
+}
+
+bool RealtimeThread::start(RealtimeRole role, std::function<void()> entry) {
+    if (_impl->running) {
+        return false;
+    }
+
+    _impl->role = role;
+    _impl->entry = std::move(entry);
+    _impl->stackBytes = std::max<size_t>(s_config.stackBytes, PTHREAD_STACK_MIN);
+
+    // the whole stack is populated (and locked, under MCL_FUTURE) before the thread runs
+    if (_impl->stack == nullptr) {
+        void* stack = mmap(nullptr,
+                           _impl->stackBytes,
+                           PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK | MAP_POPULATE,
+                           -1,
+                           0);
+        if (stack == MAP_FAILED) {
+            okay::Engine.logger.error("Unable to allocate {} thread stack", roleName(role));
+            return false;
+        }
+        _impl->stack = stack;
+    }
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, _impl->stack, _impl->stackBytes);
+
+    if (s_config.enabled) {
+        sched_param param{};
+        param.sched_priority = priorityFor(role);
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &param);
+
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpuFor(role), &cpus);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+    }
+
+    int err = pthread_create(&_impl->thread, &attr, &RealtimeThreadImpl::run, _impl.get());
+    if (err == EPERM && s_config.enabled) {
+        okay::Engine.logger.error("No permission for SCHED_FIFO, starting {} thread unprioritised",
+                                  roleName(role));
+        pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+        err = pthread_create(&_impl->thread, &attr, &RealtimeThreadImpl::run, _impl.get());
+    }
+    pthread_attr_destroy(&attr);
+
+    if (err != 0) {
+        okay::Engine.logger.error(
+            "Unable to start {} thread: {}", roleName(role), std::strerror(err));
+        return false;
+    }
+
+    _impl->running = true;
+    return true;
+}
+
+void RealtimeThread::join() {
+    if (!_impl->running) {
+        return;
+    }
+
+    pthread_join(_impl->thread, nullptr);
+    _impl->running = false;
+}
+
+bool RealtimeThread::joinable() const {
+    return _impl->running;
+}
+
+struct RealtimeMutex::RealtimeMutexImpl {
+    pthread_mutex_t mutex{};
+};
+
+RealtimeMutex::RealtimeMutex() : _impl(std::make_unique<RealtimeMutexImpl>()) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&_impl->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+RealtimeMutex::~RealtimeMutex() {
+    pthread_mutex_destroy(&_impl->mutex);
+}
+
+void RealtimeMutex::lock() {
+    pthread_mutex_lock(&_impl->mutex);
+}
+
+void RealtimeMutex::unlock() {
+    pthread_mutex_unlock(&_impl->mutex);
+}
+
+// counters of a single thread. a thread is told apart by its kernel id, so one that was restarted
+// starts over instead of reporting a negative rate
+struct ThreadUsage {
+    pid_t tid = 0;
+    uint64_t minorFaults = 0;
+    uint64_t majorFaults = 0;
+    uint64_t involuntarySwitches = 0;
+};
+
+// reads a /proc file into buf without stdio, which would allocate from the main loop
+static bool readProcFile(const char* path, char* buf, size_t size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    ssize_t len = read(fd, buf, size - 1);
+    close(fd);
+    if (len <= 0) {
+        return false;
+    }
+    buf[len] = '\0';
+    return true;
+}
+
+static bool readThreadUsage(pid_t tid, ThreadUsage& usage) {
+    char path[64];
+    char buf[4096];
+
+    // minflt and majflt are the 10th and 12th fields of stat, counting from the state that
+    // follows the parenthesised name
+    std::snprintf(path, sizeof(path), "/proc/self/task/%d/stat", static_cast<int>(tid));
+    if (!readProcFile(path, buf, sizeof(buf))) {
+        return false;
+    }
+    const char* fields = std::strrchr(buf, ')');
+    unsigned long long minor = 0;
+    unsigned long long major = 0;
+    if (fields == nullptr) {
+        return false;
+    }
+    if (std::sscanf(fields + 1, " %*c %*d %*d %*d %*d %*d %*u %llu %*u %llu", &minor, &major) !=
+        2) {
+        return false;
+    }
+
+    std::snprintf(path, sizeof(path), "/proc/self/task/%d/status", static_cast<int>(tid));
+    if (!readProcFile(path, buf, sizeof(buf))) {
+        return false;
+    }
+    const char* switches = std::strstr(buf, "nonvoluntary_ctxt_switches:");
+    if (switches == nullptr) {
+        return false;
+    }
+
+    usage.tid = tid;
+    usage.minorFaults = minor;
+    usage.majorFaults = major;
+    usage.involuntarySwitches =
+        std::strtoull(switches + std::strlen("nonvoluntary_ctxt_switches:"), nullptr, 10);
+    return true;
+}
+
+// the main thread is the one calling tickRealtimeStats, so it can ask for itself
+static bool readOwnUsage(ThreadUsage& usage) {
+    rusage own{};
+    if (getrusage(RUSAGE_THREAD, &own) != 0) {
+        return false;
+    }
+
+    usage.tid = threadId();
+    usage.minorFaults = static_cast<uint64_t>(own.ru_minflt);
+    usage.majorFaults = static_cast<uint64_t>(own.ru_majflt);
+    usage.involuntarySwitches = static_cast<uint64_t>(own.ru_nivcsw);
+    return true;
+}
+
+static void reportUsage(const char* name,
+                        const ThreadUsage& usage,
+                        ThreadUsage& last,
+                        double seconds) {
+    if (usage.tid == last.tid) {
+        okay::Engine.logger.info(
+            "rt {}: {:.1f} minor faults/s, {:.1f} major faults/s, {:.1f} involuntary switches/s",
+            name,
+            (usage.minorFaults - last.minorFaults) / seconds,
+            (usage.majorFaults - last.majorFaults) / seconds,
+            (usage.involuntarySwitches - last.involuntarySwitches) / seconds);
+    }
+    last = usage;
+}
+
+void tickRealtimeStats() {
+    if (!s_config.enabled) {
+        return;
+    }
+
+    using namespace std::chrono;
+    static steady_clock::time_point lastReport = steady_clock::now();
+    static ThreadUsage lastMain;
+    static std::array<ThreadUsage, NUM_ROLES> lastRoles;
+
+    steady_clock::time_point now = steady_clock::now();
+    double seconds = duration<double>(now - lastReport).count();
+    if (seconds < 1.0) {
+        return;
+    }
+
+    ThreadUsage usage;
+    if (readOwnUsage(usage)) {
+        reportUsage("main", usage, lastMain, seconds);
+    }
+
+    for (size_t i = 0; i < NUM_ROLES; i++) {
+        pid_t tid = s_roleTids[i].load(std::memory_order_relaxed);
+        if (tid != 0 && readThreadUsage(tid, usage)) {
+            reportUsage(roleName(static_cast<RealtimeRole>(i)), usage, lastRoles[i], seconds);
+        }
+    }
+
+    lastReport = now;
+}
+
+} // namespace dash::platform
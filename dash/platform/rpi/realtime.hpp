@@ -0,0 +1,9 @@
+#include <platform/platform.hpp>
+
+namespace dash::platform {
+
+// reports page faults and involuntary context switches of the main, CAN and
+// input threads once per second while real-time mode is enabled
+void tickRealtimeStats();
+
+} // namespace dash::platform
@@ -1,4 +1,5 @@
 #include <platform/platform.hpp>
+#include <perf/trace.hpp>
 
 #include <cerrno>
 #include <cstring>
@@ -98,6 +99,7 @@ SPI::SPI(const std::string &device, uint32_t speedHz, uint8_t mode,
 SPI::~SPI() = default;
 
 bool SPI::ISpi_transfer(const uint8_t *tx, uint8_t *rx, size_t len) {
+  DASH_TRACE_SCOPE("SPI::ISpi_transfer");
   return _impl->transfer(tx, rx, len);
 }
 
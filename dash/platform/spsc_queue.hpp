@@ -0,0 +1,54 @@
+#ifndef __SPSC_QUEUE_HPP__
+#define __SPSC_QUEUE_HPP__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace dash::platform {
+
+// Fixed capacity single-producer/single-consumer queue. push() is only called from the producer
+// thread and pop() only from the consumer, neither ever blocks or allocates. A full queue rejects
+// the push so the producer can count the drop.
+template <typename T, size_t CAPACITY>
+class SpscQueue {
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+   public:
+    bool push(const T& value) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == CAPACITY) {
+            return false;
+        }
+
+        _items[tail & (CAPACITY - 1)] = value;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        out = _items[head & (CAPACITY - 1)];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+   private:
+    std::array<T, CAPACITY> _items{};
+
+    // kept on separate cache lines so the two threads don't bounce one line between them
+    alignas(64) std::atomic<size_t> _head{0};
+    alignas(64) std::atomic<size_t> _tail{0};
+};
+
+}  // namespace dash::platform
+
+#endif  // __SPSC_QUEUE_HPP__
@@ -0,0 +1,111 @@
+#ifndef __WS2812_SPI_HPP__
+#define __WS2812_SPI_HPP__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// WS2812 bitstreams encoded as SPI MOSI data. Every LED bit becomes BITS SPI bits clocked at
+// BITS * 800kHz, a 1 is mostly high and a 0 mostly low:
+//
+//   3 bits @ 2.4MHz: 1 -> 110, 0 -> 100
+//   4 bits @ 3.2MHz: 1 -> 1110, 0 -> 1000
+//
+// Input is the strip words produced by encodePixel/encodePixels (r in byte 0, g in byte 1, b in
+// byte 2). They go out in the strip's G, R, B order, the same order ws2811 produces for them with
+// WS2811_STRIP_GBR on the PWM backend.
+namespace dash::platform::ws2812 {
+
+static constexpr uint32_t LED_BIT_HZ = 800'000;
+
+// the strip latches after the line is held low for this long, newer WS2812Bs need > 280us
+static constexpr uint32_t RESET_US = 300;
+
+// byte offsets into a strip word, in wire order
+static constexpr std::array<uint8_t, 3> WIRE_ORDER = {1, 0, 2};
+
+template <size_t BITS>
+struct Encoding {
+    static_assert(BITS == 3 || BITS == 4, "WS2812 over SPI needs 3 or 4 bits per LED bit");
+
+    static constexpr uint32_t SPI_HZ = LED_BIT_HZ * BITS;
+    static constexpr size_t BYTES_PER_COLOR = BITS;  // 8 LED bits * BITS / 8
+    static constexpr size_t BYTES_PER_LED = BYTES_PER_COLOR * WIRE_ORDER.size();
+    static constexpr size_t RESET_BYTES =
+        (static_cast<uint64_t>(SPI_HZ) * RESET_US / 1'000'000 + 7) / 8;
+
+    static constexpr uint32_t ONE = BITS == 3 ? 0b110 : 0b1110;
+    static constexpr uint32_t ZERO = BITS == 3 ? 0b100 : 0b1000;
+
+    // SPI pattern for every color byte, msb first, in the low BYTES_PER_COLOR bytes
+    static constexpr std::array<uint32_t, 256> TABLE = [] {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t value = 0; value < 256; value++) {
+            uint32_t pattern = 0;
+            for (int bit = 7; bit >= 0; bit--) {
+                pattern = (pattern << BITS) | (((value >> bit) & 1u) ? ONE : ZERO);
+            }
+            table[value] = pattern;
+        }
+        return table;
+    }();
+
+    static constexpr size_t bufferSize(size_t numLeds) {
+        return numLeds * BYTES_PER_LED + RESET_BYTES;
+    }
+
+    // writes bufferSize(count) bytes, the reset gap included, and returns how many
+    static constexpr size_t encode(const uint32_t* words, size_t count, uint8_t* out) {
+        size_t pos = 0;
+        for (size_t i = 0; i < count; i++) {
+            for (uint8_t byteIdx : WIRE_ORDER) {
+                uint32_t pattern = TABLE[(words[i] >> (byteIdx * 8)) & 0xFFu];
+                for (int b = static_cast<int>(BYTES_PER_COLOR) - 1; b >= 0; b--) {
+                    out[pos++] = static_cast<uint8_t>(pattern >> (b * 8));
+                }
+            }
+        }
+        for (size_t i = 0; i < RESET_BYTES; i++) {
+            out[pos++] = 0;
+        }
+        return pos;
+    }
+};
+
+namespace detail {
+
+// r = 0x00, g = 0xFF, b = 0x0F goes out as G R B = FF 00 0F
+static constexpr uint32_t GOLDEN_WORD = 0x000F'FF00;
+
+template <size_t BITS, size_t N>
+constexpr bool matchesGolden(const std::array<uint8_t, N>& golden) {
+    std::array<uint8_t, Encoding<BITS>::bufferSize(1)> out{};
+    Encoding<BITS>::encode(&GOLDEN_WORD, 1, out.data());
+    for (size_t i = 0; i < out.size(); i++) {
+        uint8_t expected = i < golden.size() ? golden[i] : 0;
+        if (out[i] != expected) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(matchesGolden<3>(std::array<uint8_t, 9>{
+                  0xDB, 0x6D, 0xB6,  // 0xFF
+                  0x92, 0x49, 0x24,  // 0x00
+                  0x92, 0x4D, 0xB6,  // 0x0F
+              }),
+              "3 bit WS2812 encoding doesn't match the golden bitstream");
+
+static_assert(matchesGolden<4>(std::array<uint8_t, 12>{
+                  0xEE, 0xEE, 0xEE, 0xEE,  // 0xFF
+                  0x88, 0x88, 0x88, 0x88,  // 0x00
+                  0x88, 0x88, 0xEE, 0xEE,  // 0x0F
+              }),
+              "4 bit WS2812 encoding doesn't match the golden bitstream");
+
+}  // namespace detail
+
+}  // namespace dash::platform::ws2812
+
+#endif  // __WS2812_SPI_HPP__